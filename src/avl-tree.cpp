@@ -1,3 +1,6 @@
+#ifndef AVL_TREE_CPP
+#define AVL_TREE_CPP
+
 #include "avl-tree.h"
 #include <cassert>
 #include <stdexcept>
@@ -90,6 +93,22 @@ bool AVLTree<ElemT>::contains(ElemT key) {
     return search(root, key) != nullptr;
 }
 
+/* Returns the number of keys smaller than the given one
+   (a single root-leaf walk). */
+template <typename ElemT>
+unsigned int AVLTree<ElemT>::countLess(ElemT key) const {
+    unsigned int result = 0;
+    const AVLTreeNode<ElemT> *node = root;
+    while (node != nullptr) {
+        if (node->key < key) {
+            result += (node->left ? node->left->count : 0) + 1;
+            node = node->right;
+        }
+        else node = node->left;
+    }
+    return result;
+}
+
 template <typename ElemT>
 int AVLTree<ElemT>::getCount(const auto *node) {
     if (node == nullptr) return 0;
@@ -246,6 +265,28 @@ void AVLTree<ElemT>::collectKeysHelper(auto *node, vector<ElemT> &result) {
     collectKeysHelper(node->right, result);
 }
 
+/* Replaces the contents of the tree with the provided keys, which
+   have to be sorted. Runs in linear time (no rotations needed). */
+template <typename ElemT>
+void AVLTree<ElemT>::assignSorted(const vector<ElemT> &keys) {
+    clearTree(root);
+    root = buildBalanced(keys, 0, keys.size());
+    nodeCount = keys.size();
+}
+
+/* Builds a perfectly balanced tree over keys[from, to). */
+template <typename ElemT>
+AVLTreeNode<ElemT>* AVLTree<ElemT>::buildBalanced(const vector<ElemT> &keys,
+                                                  int from, int to) {
+    if (from >= to) return nullptr;
+    int middle = from + (to - from) / 2;
+    AVLTreeNode<ElemT> *node = new AVLTreeNode<ElemT>(keys[middle]);
+    node->left = buildBalanced(keys, from, middle);
+    node->right = buildBalanced(keys, middle + 1, to);
+    updateAuxValues(node);
+    return node;
+}
+
 /* Prints the bracket representation of the tree (for debug purposes) */
 template <typename ElemT>
 void AVLTree<ElemT>::printTree(ostream &outputStream) {
@@ -268,3 +309,4 @@ void AVLTree<ElemT>::printTreeHelper(auto *node, ostream &outputStream) {
     outputStream << ")";
 }
 
+#endif
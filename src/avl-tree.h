@@ -53,6 +53,9 @@ class AVLTree {
         /* Searches for the specified key in the tree. */
         bool contains(ElemT key);
         
+        /* Returns the number of keys smaller than the given one. */
+        unsigned int countLess(ElemT key) const;
+        
         /* Adds a new key, allowing multiple occurrences of the same key. */
         void insert(ElemT key);
         
@@ -63,6 +66,10 @@ class AVLTree {
         /* Returns a vector containing all keys stored in the tree. */
         vector<ElemT> collectKeys();
         
+        /* Replaces the contents of the tree with the provided keys, which
+           have to be sorted. Runs in linear time (no rotations needed). */
+        void assignSorted(const vector<ElemT> &keys);
+        
         /* Prints the bracket representation of the tree (for debug purposes) */
         void printTree(ostream &outputStream);
     
@@ -85,6 +92,7 @@ class AVLTree {
         AVLTreeNode<ElemT>* dropMinNode(auto *node);
         
         void collectKeysHelper(auto *node, vector<ElemT> &result);
+        AVLTreeNode<ElemT>* buildBalanced(const vector<ElemT> &keys, int from, int to);
         void printTreeHelper(auto *node, ostream &outputStream);
 };
 
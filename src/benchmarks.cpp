@@ -0,0 +1,186 @@
+
+#include "benchmarks.h"
+#include "generators.h"
+#include "converter.h"
+#include "interval-tree.h"
+#include "pooled-interval-tree.h"
+#include "solver.h"
+#include "parallel.h"
+#include <chrono>
+#include <vector>
+using std::vector;
+using std::pair;
+using namespace std::chrono;
+
+
+/* Benchmarks are launched with "no-flip-tester --bench <name>".
+   Returns false if there is no benchmark with the given name. */
+bool runBenchmark(const string &name, ostream &outputStream) {
+    if (name == "generators") benchmarkGeneratorEngines(outputStream);
+    else if (name == "large-instance") benchmarkLargeInstance(outputStream);
+    else if (name == "interval-trees") benchmarkIntervalTrees(outputStream);
+    else if (name == "speculative-solver") benchmarkSpeculativeSolver(outputStream);
+    else return false;
+    return true;
+}
+
+/* milliseconds elapsed since "start" */
+double millisSince(steady_clock::time_point start) {
+    return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+/* "generators": raw engine throughput and instance generation time
+   (10^6 operations) for every RandomEngine backend. */
+void benchmarkGeneratorEngines(ostream &outputStream) {
+    const vector<pair<EngineType, string>> engines = {
+        {MERSENNE_TWISTER, "mt19937"}, {XOSHIRO256, "xoshiro256**"} };
+    const int DRAWS = 100000000;
+    const int NODES = 1000;
+    const int ALPHA = 2;
+    const int INSTANCE_LEN = 1000000;
+    random_device rd {};
+    
+    for (auto &engineInfo : engines) {
+        RandomEngine engine(engineInfo.first);
+        engine.seed(2024);
+        
+        auto start = steady_clock::now();
+        uint32_t checksum = 0; // keeps the loop from being optimized away
+        for (int d = 0; d < DRAWS; d++) checksum ^= engine();
+        double rawMillis = millisSince(start);
+        
+        UniformDistrGenerator gen(NODES, ALPHA, rd, 0.8, 0.001);
+        gen.setEngineType(engineInfo.first);
+        gen.setSeed(2024);
+        start = steady_clock::now();
+        OrientationProblemInstance opi = gen.generateInstance(INSTANCE_LEN);
+        double generationMillis = millisSince(start);
+        
+        outputStream << engineInfo.second << ": " << DRAWS / rawMillis / 1000 <<
+            " M draws/s (checksum " << checksum << "), " << INSTANCE_LEN <<
+            " operations (|V| = " << NODES << ", alpha = " << ALPHA << ") in " <<
+            generationMillis << " ms\n";
+    }
+}
+
+/* "large-instance": generateSequence throughput on a graph with 10^6 vertices
+   (10^7 operations), with commands consumed on the fly instead of stored. */
+void benchmarkLargeInstance(ostream &outputStream) {
+    const int NODES = 1000000;
+    const int ALPHA = 2;
+    const long long INSTANCE_LEN = 10000000;
+    random_device rd {};
+    
+    UniformDistrGenerator gen(NODES, ALPHA, rd, 0.5, 0.0001);
+    gen.setEngineType(XOSHIRO256);
+    gen.setSeed(2024);
+    
+    auto start = steady_clock::now();
+    long long inserts = 0, checksum = 0;
+    gen.generateSequence(INSTANCE_LEN, [&](const Command &cmd) {
+        inserts += cmd.operation == INSERT;
+        checksum += cmd.nodes.first ^ cmd.nodes.second;
+    });
+    double generationMillis = millisSince(start);
+    
+    outputStream << INSTANCE_LEN << " operations (|V| = " << NODES << ", alpha = " <<
+        ALPHA << ") in " << generationMillis << " ms, " << inserts <<
+        " insertions (checksum " << checksum << ")\n";
+}
+
+/* Performs the interval tree operations of solveInstance, with intervals
+   processed in the order of their start times instead of by score.
+   Returns a checksum of the query results. */
+template <typename TreeT>
+long long replaySolverOperations(IntervalProblemInstance &ipi) {
+    vector<TreeT> setIntervals(ipi.V), notsetIntervals(ipi.V);
+    for (Interval &intv : ipi.intervals) {
+        notsetIntervals[intv.nodes.first].insert(intv.startTime, intv.endTime);
+        notsetIntervals[intv.nodes.second].insert(intv.startTime, intv.endTime);
+    }
+    
+    long long checksum = 0;
+    for (Interval &intv : ipi.intervals) {
+        notsetIntervals[intv.nodes.first].remove(intv.startTime, intv.endTime);
+        notsetIntervals[intv.nodes.second].remove(intv.startTime, intv.endTime);
+        int fstCollisions = setIntervals[intv.nodes.first]
+            .countClashes(intv.startTime, intv.endTime);
+        int sndCollisions = setIntervals[intv.nodes.second]
+            .countClashes(intv.startTime, intv.endTime);
+        
+        int assignedNode = fstCollisions > sndCollisions ?
+            intv.nodes.second : intv.nodes.first;
+        setIntervals[assignedNode].insert(intv.startTime, intv.endTime);
+        notsetIntervals[assignedNode].forEachClash(intv.startTime, intv.endTime,
+            [&checksum](int clashLow, int clashHigh) { checksum += clashLow ^ clashHigh; });
+        checksum += fstCollisions + sndCollisions;
+    }
+    return checksum;
+}
+
+/* "interval-trees": IntervalTree against PooledIntervalTree on the
+   operations of solveInstance, for sparse and dense overlap instances. */
+void benchmarkIntervalTrees(ostream &outputStream) {
+    const int INSTANCE_LEN = 200000;
+    random_device rd {};
+    
+    UniformDistrGenerator sparseGen(2000, 2, rd, 0.5, 0.001);
+    GeomDistrGenerator denseGen(200, 4, rd, 0.9, 0.0, 0.2);
+    const vector<pair<Generator*, string>> workloads = {
+        {&sparseGen, "uniform, |V| = 2000"}, {&denseGen, "geometric, |V| = 200"} };
+    
+    for (auto &workload : workloads) {
+        workload.first->setSeed(2024);
+        OrientationProblemInstance opi = workload.first->generateInstance(INSTANCE_LEN);
+        IntervalProblemInstance ipi = convertInstance(opi);
+        
+        auto start = steady_clock::now();
+        long long pointerChecksum = replaySolverOperations<IntervalTree>(ipi);
+        double pointerMillis = millisSince(start);
+        
+        start = steady_clock::now();
+        long long pooledChecksum = replaySolverOperations<PooledIntervalTree>(ipi);
+        double pooledMillis = millisSince(start);
+        
+        outputStream << workload.second << ", " << ipi.intervals.size() << " intervals: " <<
+            "IntervalTree " << pointerMillis << " ms, PooledIntervalTree " <<
+            pooledMillis << " ms" << (pointerChecksum == pooledChecksum ?
+            "" : " (RESULTS DIFFER)") << "\n";
+    }
+}
+
+/* "speculative-solver": solveInstance against solveInstanceSpeculative
+   (several batch sizes, all hardware threads) on 10^6 operations over
+   10^5 vertices, with the deviation of the maximum outdegree. */
+void benchmarkSpeculativeSolver(ostream &outputStream) {
+    const int NODES = 100000;
+    const int ALPHA = 2;
+    const int INSTANCE_LEN = 1000000;
+    const vector<int> batchSizes = {16, 256, 4096};
+    random_device rd {};
+    
+    UniformDistrGenerator gen(NODES, ALPHA, rd, 0.5, 0.001);
+    gen.setSeed(2024);
+    OrientationProblemInstance opi = gen.generateInstance(INSTANCE_LEN);
+    const IntervalProblemInstance ipi = convertInstance(opi);
+    SolverWorkspace workspace(getHardwareThreads());
+    
+    IntervalProblemInstance serialCopy = ipi;
+    int serialMaxOutdegree = 0;
+    auto start = steady_clock::now();
+    solveInstance(serialCopy, serialMaxOutdegree, workspace);
+    outputStream << ipi.intervals.size() << " intervals, " << getHardwareThreads() <<
+        " threads: solveInstance " << millisSince(start) << " ms, max outdegree " <<
+        serialMaxOutdegree << "\n";
+    
+    for (int batchSize : batchSizes) {
+        IntervalProblemInstance speculativeCopy = ipi;
+        int speculativeMaxOutdegree = 0;
+        start = steady_clock::now();
+        solveInstanceSpeculative(speculativeCopy, speculativeMaxOutdegree,
+                                 workspace, batchSize);
+        outputStream << "batch " << batchSize << ": " << millisSince(start) <<
+            " ms, max outdegree " << speculativeMaxOutdegree << " (deviation " <<
+            speculativeMaxOutdegree - serialMaxOutdegree << ")\n";
+    }
+}
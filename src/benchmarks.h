@@ -0,0 +1,35 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <iostream>
+#include <string>
+#include <chrono>
+using std::ostream;
+using std::string;
+
+
+/* Benchmarks are launched with "no-flip-tester --bench <name>".
+   Returns false if there is no benchmark with the given name. */
+bool runBenchmark(const string &name, ostream &outputStream);
+
+/* milliseconds elapsed since "start" */
+double millisSince(std::chrono::steady_clock::time_point start);
+
+/* "generators": raw engine throughput and instance generation time
+   (10^6 operations) for every RandomEngine backend. */
+void benchmarkGeneratorEngines(ostream &outputStream);
+
+/* "large-instance": generateSequence throughput on a graph with 10^6 vertices
+   (10^7 operations), with commands consumed on the fly instead of stored. */
+void benchmarkLargeInstance(ostream &outputStream);
+
+/* "interval-trees": IntervalTree against PooledIntervalTree on the
+   operations of solveInstance, for sparse and dense overlap instances. */
+void benchmarkIntervalTrees(ostream &outputStream);
+
+/* "speculative-solver": solveInstance against solveInstanceSpeculative
+   (several batch sizes, all hardware threads) on 10^6 operations over
+   10^5 vertices, with the deviation of the maximum outdegree. */
+void benchmarkSpeculativeSolver(ostream &outputStream);
+
+#endif
@@ -1,9 +1,15 @@
 #include "converter.h"
 #include <map>
 #include <cassert>
+#include <algorithm>
 using std::to_string;
 using std::ostream;
 using std::map;
+using std::sort;
+using std::swap;
+using std::max;
+using std::unique;
+using std::lower_bound;
 
 
 int Interval::getAssignedNode() const {
@@ -42,9 +48,17 @@ IntervalProblemInstance convertInstance(OrientationProblemInstance &opi) {
        and vectors with timestamps when the edge is considered. */
     map< pair<int,int>, vector<int> > history;
     
+    // current degree of every vertex, the largest one is the degree bound
+    vector<int> degree(opi.V, 0);
+    
     int currentTime = 0;
     for (Command &cmd : opi.sequence) {
         pair<int,int> nodes = cmd.nodes;
+        const int change = cmd.operation == INSERT ? +1 : -1;
+        degree[nodes.first] += change;
+        degree[nodes.second] += change;
+        ipi.degreeBound = max(ipi.degreeBound, max(degree[nodes.first], degree[nodes.second]));
+        
         auto nodesIter = history.find(nodes);
         if (nodesIter != history.end()) { // key exists
             vector<int> &timestamps = nodesIter->second;
@@ -78,3 +92,139 @@ IntervalProblemInstance convertInstance(OrientationProblemInstance &opi) {
     return ipi;
 }
 
+
+/* Returns ipi.degreeBound, or computes it by a sweep over the
+   intervals when the instance does not carry it. */
+int getDegreeBound(const IntervalProblemInstance &ipi) {
+    if (ipi.degreeBound > 0) return ipi.degreeBound;
+    
+    /* Interval bounds are inclusive, so at equal times the start
+       events (+1) are processed before the end events (-1). */
+    vector<vector<pair<int,int>>> events(ipi.V);
+    for (const Interval &intv : ipi.intervals) {
+        events[intv.nodes.first].emplace_back(intv.startTime, -1);
+        events[intv.nodes.first].emplace_back(intv.endTime, +1);
+        events[intv.nodes.second].emplace_back(intv.startTime, -1);
+        events[intv.nodes.second].emplace_back(intv.endTime, +1);
+    }
+    
+    int bound = 0;
+    for (vector<pair<int,int>> &vertexEvents : events) {
+        sort(vertexEvents.begin(), vertexEvents.end());
+        int degree = 0;
+        for (pair<int,int> &event : vertexEvents) {
+            degree -= event.second;
+            bound = max(bound, degree);
+        }
+    }
+    return bound;
+}
+
+/* Collects the indexes of intervals incident to each vertex, every
+   bucket sorted by the interval start time. */
+vector<vector<int>> bucketIntervalsByVertex(const IntervalProblemInstance &ipi) {
+    vector<vector<int>> buckets(ipi.V);
+    for (int i = 0; i < ipi.intervals.size(); i++) {
+        buckets[ipi.intervals[i].nodes.first].push_back(i);
+        buckets[ipi.intervals[i].nodes.second].push_back(i);
+    }
+    
+    for (vector<int> &bucket : buckets) {
+        sort(bucket.begin(), bucket.end(), [&ipi](int a, int b) {
+            return ipi.intervals[a] < ipi.intervals[b];
+        });
+    }
+    return buckets;
+}
+
+DisjointSets::DisjointSets(int count) : parent(count), size(count, 1) {
+    for (int x = 0; x < count; x++) parent[x] = x;
+}
+
+int DisjointSets::find(int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]]; // path halving
+        x = parent[x];
+    }
+    return x;
+}
+
+void DisjointSets::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+    if (size[a] < size[b]) swap(a, b);
+    parent[b] = a;
+    size[a] += size[b];
+}
+
+/* Splits the instance into independent subinstances: two intervals end up
+   in the same component iff they are linked by a chain of intervals, each
+   sharing a vertex with the next one and overlapping with it in time.
+   origins[c][i] is the index (in ipi.intervals) of the i-th interval
+   of component c; intervals keep their relative order. */
+vector<IntervalProblemInstance> splitIntoComponents(const IntervalProblemInstance &ipi,
+                                                    vector<vector<int>> &origins,
+                                                    vector<vector<int>> &vertexOrigins) {
+    DisjointSets components(ipi.intervals.size());
+    vector<vector<int>> buckets = bucketIntervalsByVertex(ipi);
+    
+    /* Within a vertex, sweeping by start time it suffices to link each
+       interval with the latest-ending interval seen so far. */
+    for (vector<int> &bucket : buckets) {
+        int reaching = -1; // interval with the largest endTime so far
+        for (int index : bucket) {
+            const Interval &intv = ipi.intervals[index];
+            if (reaching != -1 && intv.startTime <= ipi.intervals[reaching].endTime) {
+                components.unite(reaching, index);
+            }
+            if (reaching == -1 || intv.endTime > ipi.intervals[reaching].endTime) {
+                reaching = index;
+            }
+        }
+    }
+    
+    vector<IntervalProblemInstance> subinstances;
+    map<int,int> componentNumber; // union-find representative -> component
+    vector<int> intervalComponent(ipi.intervals.size());
+    origins.clear();
+    vertexOrigins.clear();
+    
+    for (int i = 0; i < ipi.intervals.size(); i++) {
+        int root = components.find(i);
+        auto iter = componentNumber.find(root);
+        if (iter == componentNumber.end()) {
+            iter = componentNumber.emplace(root, origins.size()).first;
+            origins.emplace_back();
+            vertexOrigins.emplace_back();
+        }
+        const int c = iter->second;
+        intervalComponent[i] = c;
+        origins[c].push_back(i);
+        vertexOrigins[c].push_back(ipi.intervals[i].nodes.first);
+        vertexOrigins[c].push_back(ipi.intervals[i].nodes.second);
+    }
+    
+    /* Vertices of every component are relabeled to 0..k-1, preserving
+       their order, so the size of a subinstance does not depend on V. */
+    for (vector<int> &labels : vertexOrigins) {
+        sort(labels.begin(), labels.end());
+        labels.erase(unique(labels.begin(), labels.end()), labels.end());
+    }
+    for (int c = 0; c < origins.size(); c++) {
+        subinstances.push_back({(int)vertexOrigins[c].size(), ipi.alpha, ipi.timeframe});
+        subinstances.back().degreeBound = ipi.degreeBound; // still an upper bound
+    }
+    
+    auto localLabel = [&vertexOrigins](int c, int v) {
+        return lower_bound(vertexOrigins[c].begin(), vertexOrigins[c].end(), v)
+            - vertexOrigins[c].begin();
+    };
+    for (int i = 0; i < ipi.intervals.size(); i++) {
+        const int c = intervalComponent[i];
+        Interval intv = ipi.intervals[i];
+        intv.nodes = {localLabel(c, intv.nodes.first), localLabel(c, intv.nodes.second)};
+        subinstances[c].intervals.push_back(intv);
+    }
+    return subinstances;
+}
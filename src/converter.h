@@ -40,6 +40,10 @@ struct IntervalProblemInstance {
     const int timeframe; // largest timestamp + 1
     vector<Interval> intervals;
     
+    /* Upper bound on the number of intervals incident to a single vertex
+       at any moment, hence on every outdegree; 0 when unknown. */
+    int degreeBound = 0;
+    
     // pretty-printer of the entire intervals set
     void printIntervals(std::ostream &outputStream);
 };
@@ -48,5 +52,36 @@ struct IntervalProblemInstance {
    graph orientation problem to interval-based setting. */
 IntervalProblemInstance convertInstance(OrientationProblemInstance &opi);
 
+/* Returns ipi.degreeBound, or computes it by a sweep over the
+   intervals when the instance does not carry it. */
+int getDegreeBound(const IntervalProblemInstance &ipi);
+
+/* Collects the indexes of intervals incident to each vertex, every
+   bucket sorted by the interval start time. */
+vector<vector<int>> bucketIntervalsByVertex(const IntervalProblemInstance &ipi);
+
+// Union-find structure with path compression and union by size.
+class DisjointSets {
+    private:
+        vector<int> parent;
+        vector<int> size;
+    
+    public:
+        DisjointSets(int count);
+        int find(int x);
+        void unite(int a, int b);
+};
+
+/* Splits the instance into independent subinstances: two intervals end up
+   in the same component iff they are linked by a chain of intervals, each
+   sharing a vertex with the next one and overlapping with it in time.
+   origins[c][i] is the index (in ipi.intervals) of the i-th interval
+   of component c; intervals keep their relative order. Vertices of a
+   component are relabeled to 0..k-1 in increasing order of their original
+   labels, vertexOrigins[c][w] being the original label of vertex w. */
+vector<IntervalProblemInstance> splitIntoComponents(const IntervalProblemInstance &ipi,
+                                                    vector<vector<int>> &origins,
+                                                    vector<vector<int>> &vertexOrigins);
+
 #endif
 
@@ -0,0 +1,49 @@
+
+#include "fenwick-tree.h"
+#include <cassert>
+
+
+/* Resizes the tree and sets all elements to zero. */
+template <typename ElemT>
+void FenwickTree<ElemT>::assign(int size) {
+    tree.assign(size + 1, ElemT {});
+    highestPower = 1;
+    while (2 * highestPower <= size) highestPower *= 2;
+}
+
+/* Adds delta to the element at the given index. */
+template <typename ElemT>
+void FenwickTree<ElemT>::add(int index, ElemT delta) {
+    assert (0 <= index && index < getSize());
+    for (int i = index + 1; i < tree.size(); i += i & (-i)) {
+        tree[i] += delta;
+    }
+}
+
+/* Returns the sum of the first "count" elements. */
+template <typename ElemT>
+ElemT FenwickTree<ElemT>::prefixSum(int count) {
+    assert (0 <= count && count <= getSize());
+    ElemT sum = ElemT {};
+    for (int i = count; i > 0; i -= i & (-i)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+/* Returns the smallest index such that the sum of elements up to
+   (and including) that index exceeds target. Elements must be
+   nonnegative and target must be smaller than total(). */
+template <typename ElemT>
+int FenwickTree<ElemT>::findByPrefix(ElemT target) {
+    int position = 0; // number of elements known to sum up to at most target
+    for (int step = highestPower; step > 0; step /= 2) {
+        int next = position + step;
+        if (next < tree.size() && !(target < tree[next])) {
+            position = next;
+            target -= tree[next];
+        }
+    }
+    assert (position < getSize());
+    return position;
+}
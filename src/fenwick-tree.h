@@ -0,0 +1,40 @@
+#ifndef FENWICK_TREE_H
+#define FENWICK_TREE_H
+
+#include <vector>
+using std::vector;
+
+
+/* Fenwick (binary indexed) tree over elements of type ElemT, indexed from 0.
+   Supports point updates, prefix sums and - as long as all elements are
+   nonnegative - searching for the element where a prefix sum is exceeded. */
+template <typename ElemT>
+class FenwickTree {
+    private:
+        vector<ElemT> tree; // tree[i] sums a block of elements ending at i-1
+        int highestPower;   // largest power of two not exceeding size
+    
+    public:
+        FenwickTree(int size = 0) { assign(size); }
+        
+        int getSize() { return tree.size() - 1; }
+        
+        /* Resizes the tree and sets all elements to zero. */
+        void assign(int size);
+        
+        /* Adds delta to the element at the given index. */
+        void add(int index, ElemT delta);
+        
+        /* Returns the sum of the first "count" elements. */
+        ElemT prefixSum(int count);
+        
+        /* Returns the sum of all elements. */
+        ElemT total() { return prefixSum(getSize()); }
+        
+        /* Returns the smallest index such that the sum of elements up to
+           (and including) that index exceeds target. Elements must be
+           nonnegative and target must be smaller than total(). */
+        int findByPrefix(ElemT target);
+};
+
+#endif
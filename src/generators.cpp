@@ -1,12 +1,16 @@
 #include "generators.h"
+#include "parallel.h"
 #include <fstream>
+#include <cmath>
+#include <unordered_set>
+#include <cassert>
 using std::min;
 using std::swap;
 using std::to_string;
 using std::make_pair;
-using std::uniform_real_distribution;
-using std::uniform_int_distribution;
-using std::geometric_distribution;
+using std::max;
+using std::prev;
+using std::unordered_set;
 
 
 string Command::printCommand() {
@@ -14,13 +18,20 @@ string Command::printCommand() {
     to_string(nodes.first) + " -- " + to_string(nodes.second) + "\n";
 }
 
+// printCommand without a temporary
+void Command::writeCommand(ostream &outputStream) const {
+    outputStream << (operation == INSERT ? "INSERT " : "DELETE ") <<
+        nodes.first << " -- " << nodes.second << '\n';
+}
+
 // pretty-printer of the entire operation sequence
 void OrientationProblemInstance::printSequence(ostream &outputStream) {
     outputStream << "|V| = " << V << ", alpha = " << alpha << "\n";
-    for (Command &c : sequence) outputStream << c.printCommand();
+    for (Command &c : sequence) c.writeCommand(outputStream);
 }
 
-Generator::Generator(int V, int alpha, random_device &rd) : V(V), alpha(alpha) {
+Generator::Generator(int V, int alpha, random_device &rd) : V(V), alpha(alpha),
+    purgeMode(RANDOM_EDGES), unitDistr(0, 1), forestDistr(0, alpha-1), vertexDistr(0, V-1) {
     engine.seed(rd());
 }
 
@@ -30,54 +41,223 @@ void Generator::setSeed(long long seed) {
 
 // "sequenceLen" is the desired number of operations
 OrientationProblemInstance Generator::generateInstance(int sequenceLen) {
-    
     OrientationProblemInstance instance = {V, alpha};
-    BoundedArbGraph graph(V, alpha); // initial empty graph
-    uniform_real_distribution<> unit(0, 1);
-    int purgeCountdown = 0; // purge phase is active iff purgeCountdown > 0
+    instance.sequence.reserve(sequenceLen);
+    generateSequence(sequenceLen, [&instance](const Command &cmd) {
+        instance.sequence.push_back(cmd);
+    });
+    return instance;
+}
+
+/* Generates the same sequence as generateInstance, but hands every
+   Command to "emit" instead of storing it. */
+void Generator::generateSequence(long long sequenceLen,
+    const function<void(const Command&)> &emit) {
     
-    for (int time = 0; time < sequenceLen; time++) {
+    BoundedArbGraph graph(V, alpha, usesComponentIndex()); // initial empty graph
+    beginInstance();
+    const long long maxEdgeCount = (V-1LL) * alpha;
+    
+    for (long long time = 0; time < sequenceLen; time++) {
         
-        OperationType type = unit(engine) < getInsertProbability(graph) ?
+        OperationType type = unitDistr(engine) < getInsertProbability(graph) ?
             INSERT : DELETE;
         
         // special cases where operation type is enforced
-        if (graph.getEdgeCount() == 0) type = INSERT;
-        else if (graph.getEdgeCount() == (V-1)*alpha) type = DELETE;
-        else if (purgeCountdown > 0) type = DELETE;
+        int edgeCount = graph.getEdgeCount();
+        if (edgeCount == 0) type = INSERT;
+        else if (edgeCount == maxEdgeCount) type = DELETE;
         
         pair<int,int> currentEdge;
         if (type == INSERT) currentEdge = insertRandomEdge(graph);
         else if (type == DELETE) currentEdge = deleteRandomEdge(graph);
-        Command cmd = {type, currentEdge};
-        instance.sequence.push_back(cmd);
+        emit(Command{type, currentEdge});
         
-        bool activatePurge = !purgeCountdown && unit(engine) < getPurgeProbability(graph);
-        if (activatePurge) {
-            uniform_int_distribution<> purgeLength(0, graph.getEdgeCount() / 2);
-            purgeCountdown = purgeLength(engine);
+        // purge phase: a continuous sequence of deletions, cut at the end of the instance
+        if (unitDistr(engine) < getPurgeProbability(graph)) {
+            long long stepsLeft = sequenceLen - time - 1;
+            vector<pair<int,int>> purged;
+            if (purgeMode == RANDOM_EDGES) {
+                long long count = uniformInt(0, graph.getEdgeCount() / 2);
+                purged = purgeRandomEdges(graph, min(count, stepsLeft));
+            }
+            else purged = purgeComponent(graph, stepsLeft);
+            
+            for (pair<int,int> &edge : purged) emit(Command{DELETE, edge});
+            time += purged.size();
         }
-        else if (purgeCountdown > 0) purgeCountdown--;
     }
-    return instance;
+}
+
+/* Deletes "count" edges of a RANDOM_EDGES purge and returns them in
+   the order of deletion. By default deleteRandomEdge is called repeatedly. */
+vector<pair<int,int>> Generator::purgeRandomEdges(BoundedArbGraph &graph, int count) {
+    vector<pair<int,int>> purged;
+    purged.reserve(count);
+    for (int i = 0; i < count; i++) purged.push_back(deleteRandomEdge(graph));
+    return purged;
+}
+
+/* Deletes "count" distinct, uniformly random edges in a single
+   BoundedArbGraph::deleteEdges call and returns them. Indices are
+   drawn with Floyd's algorithm (count draws, no rejections); the
+   deletion order is a uniformly random permutation. */
+vector<pair<int,int>> Generator::deleteUniformEdges(BoundedArbGraph &graph, int count) {
+    const int edgeCount = graph.getEdgeCount();
+    unordered_set<int> chosen;
+    vector<pair<int,int>> purged;
+    purged.reserve(count);
+    for (int j = edgeCount - count; j < edgeCount; j++) {
+        int index = uniformInt(0, j);
+        if (!chosen.insert(index).second) {
+            index = j; // j has not been drawn before
+            chosen.insert(index);
+        }
+        purged.push_back(graph.getEdge(index));
+    }
+    graph.deleteEdges(purged);
+    
+    // Floyd's picks favour high indices late, so shuffle (Fisher-Yates).
+    for (int i = count - 1; i > 0; i--) swap(purged[i], purged[uniformInt(0, i)]);
+    return purged;
+}
+
+/* Deletes the edges of the component containing a random edge, in BFS
+   order, stopping after maxCount edges; returns the deleted edges. */
+vector<pair<int,int>> Generator::purgeComponent(BoundedArbGraph &graph, long long maxCount) {
+    vector<pair<int,int>> purged;
+    if (maxCount == 0 || graph.getEdgeCount() == 0) return purged;
+    
+    vector<pair<int,int>> allEdges = graph.getAllEdges();
+    vector<int> firstEdge(V + 1, 0); // edge ids incident to every vertex
+    for (pair<int,int> &edge : allEdges) {
+        firstEdge[edge.first + 1]++;
+        firstEdge[edge.second + 1]++;
+    }
+    for (int v = 0; v < V; v++) firstEdge[v+1] += firstEdge[v];
+    vector<int> incidentEdges(firstEdge[V]);
+    vector<int> fill(firstEdge.begin(), firstEdge.end() - 1);
+    for (int e = 0; e < (int)allEdges.size(); e++) {
+        incidentEdges[fill[allEdges[e].first]++] = e;
+        incidentEdges[fill[allEdges[e].second]++] = e;
+    }
+    
+    vector<bool> edgeTaken(allEdges.size(), false);
+    vector<bool> visited(V, false);
+    vector<int> queue = { allEdges[uniformInt(0, allEdges.size()-1)].first };
+    visited[queue[0]] = true;
+    for (int head = 0; head < (int)queue.size() && (long long)purged.size() < maxCount; head++) {
+        int v = queue[head];
+        for (int i = firstEdge[v]; i < firstEdge[v+1] && (long long)purged.size() < maxCount; i++) {
+            int e = incidentEdges[i];
+            if (edgeTaken[e]) continue;
+            edgeTaken[e] = true;
+            purged.push_back(allEdges[e]);
+            int u = allEdges[e].first == v ? allEdges[e].second : allEdges[e].first;
+            if (!visited[u]) {
+                visited[u] = true;
+                queue.push_back(u);
+            }
+        }
+    }
+    
+    graph.deleteEdges(purged);
+    onEdgesPurged(purged);
+    return purged;
+}
+
+/* Writes a generated instance straight to the trace stream,
+   in the format of OrientationProblemInstance::printSequence. */
+void Generator::streamInstance(long long sequenceLen, ostream &traceStream) {
+    traceStream << "|V| = " << V << ", alpha = " << alpha << "\n";
+    generateSequence(sequenceLen, [&traceStream](const Command &cmd) {
+        cmd.writeCommand(traceStream);
+    });
+}
+
+/* Generates "count" instances in parallel. Instance i is produced by
+   a copy of this generator with its own random stream, derived from
+   masterSeed and i, so the result does not depend on "threads" and
+   every instance can be reproduced on its own (see seedStream). */
+vector<OrientationProblemInstance> Generator::generateInstances(int count, int sequenceLen,
+    unsigned long long masterSeed, int threads) {
+    
+    vector<vector<Command>> sequences(count);
+    ThreadPool pool(threads);
+    pool.parallelFor(count, [&](int i) {
+        unique_ptr<Generator> worker = clone();
+        worker->seedStream(masterSeed, i);
+        sequences[i] = worker->generateInstance(sequenceLen).sequence;
+    });
+    
+    vector<OrientationProblemInstance> instances;
+    instances.reserve(count);
+    for (vector<Command> &sequence : sequences) {
+        instances.push_back({V, alpha, std::move(sequence)});
+    }
+    return instances;
+}
+
+/* Seeds the engine with the stream-th random stream of masterSeed.
+   Seed words come from the splitmix64 sequence started at a point
+   determined by both numbers, so neighbouring streams are unrelated. */
+void Generator::seedStream(unsigned long long masterSeed, unsigned long long stream) {
+    unsigned long long state = masterSeed ^ (stream * 0xD1B54A32D192ED03ULL);
+    vector<unsigned int> words;
+    for (int w = 0; w < 4; w++) {
+        state += 0x9E3779B97F4A7C15ULL;
+        unsigned long long z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        words.push_back(z);
+        words.push_back(z >> 32);
+    }
+    seed_seq sequence(words.begin(), words.end());
+    engine.seed(sequence);
 }
 
 pair<int,int> UniformDistrGenerator::insertRandomEdge(BoundedArbGraph &graph) {
-    uniform_int_distribution<> forestDistr(0, alpha-1);
-    uniform_int_distribution<> V_Distr(0, V-1);
+    if (sampling == CROSS_COMPONENT_SAMPLING) return insertCrossComponentEdge(graph);
+    
     int forestIndex, endpointFirst, endpointSecond;
     do {
         forestIndex = forestDistr(engine);
-        endpointFirst = V_Distr(engine);
-        endpointSecond = V_Distr(engine);
+        endpointFirst = vertexDistr(engine);
+        endpointSecond = vertexDistr(engine);
     } while (!graph.insertEdge(forestIndex, endpointFirst, endpointSecond));
     if (endpointFirst > endpointSecond) swap(endpointFirst, endpointSecond);
     return make_pair(endpointFirst, endpointSecond);
 }
 
+/* Picks a forest with probability proportional to its number of cross-component
+   pairs, then a uniformly random such pair. Only edges already present in another
+   forest get rejected, hence the result is uniform over all insertable edges. */
+pair<int,int> UniformDistrGenerator::insertCrossComponentEdge(BoundedArbGraph &graph) {
+    int forestIndex;
+    pair<int,int> endpoints;
+    do {
+        long long totalPairs = 0;
+        for (int f = 0; f < alpha; f++) totalPairs += graph.getCrossPairCount(f);
+        /* No pairs means every forest is spanning, i.e. the graph is full;
+           generateSequence never inserts then (the rejection sampling
+           path would not terminate either). */
+        assert (totalPairs > 0);
+        long long rank = uniformInt(0, totalPairs-1);
+        
+        forestIndex = 0;
+        while (rank >= graph.getCrossPairCount(forestIndex)) {
+            rank -= graph.getCrossPairCount(forestIndex);
+            forestIndex++;
+        }
+        endpoints = graph.getCrossPair(forestIndex, rank);
+    } while (!graph.insertEdge(forestIndex, endpoints.first, endpoints.second));
+    if (endpoints.first > endpoints.second) swap(endpoints.first, endpoints.second);
+    return endpoints;
+}
+
 pair<int,int> UniformDistrGenerator::deleteRandomEdge(BoundedArbGraph &graph) {
-    uniform_int_distribution<> E_Distr(0, graph.getEdgeCount()-1);
-    int removedEdgeIndex = E_Distr(engine);
+    int removedEdgeIndex = uniformInt(0, graph.getEdgeCount()-1);
     pair<int,int> edgeRemoved = graph.getEdge(removedEdgeIndex);
     graph.deleteEdge(edgeRemoved.first, edgeRemoved.second);
     return edgeRemoved;
@@ -92,14 +272,11 @@ float UniformDistrGenerator::getInsertProbability(BoundedArbGraph &graph) {
 }
 
 pair<int,int> GeomDistrGenerator::insertRandomEdge(BoundedArbGraph &graph) {
-    uniform_int_distribution<> forestDistr(0, alpha-1);
-    uniform_int_distribution<> Uniform_V_Distr(0, V-1);
-    geometric_distribution<> Geom_V_Distr(succProb);
     int forestIndex, endpointFirst, endpointSecond;
     do {
         forestIndex = forestDistr(engine);
-        endpointFirst = Uniform_V_Distr(engine);
-        endpointSecond = min(Geom_V_Distr(engine), V-1);
+        endpointFirst = vertexDistr(engine);
+        endpointSecond = min(geomDistr(engine), V-1);
         // the entire distribution tail corresponds to the last node
     } while (!graph.insertEdge(forestIndex, endpointFirst, endpointSecond));
     if (endpointFirst > endpointSecond) swap(endpointFirst, endpointSecond);
@@ -107,8 +284,7 @@ pair<int,int> GeomDistrGenerator::insertRandomEdge(BoundedArbGraph &graph) {
 }
 
 pair<int,int> GeomDistrGenerator::deleteRandomEdge(BoundedArbGraph &graph) {
-    uniform_int_distribution<> E_Distr(0, graph.getEdgeCount()-1);
-    int removedEdgeIndex = E_Distr(engine);
+    int removedEdgeIndex = uniformInt(0, graph.getEdgeCount()-1);
     pair<int,int> edgeRemoved = graph.getEdge(removedEdgeIndex);
     graph.deleteEdge(edgeRemoved.first, edgeRemoved.second);
     return edgeRemoved;
@@ -122,3 +298,226 @@ float GeomDistrGenerator::getInsertProbability(BoundedArbGraph &graph) {
     else return (1 - currentDensity) / (2 - 2 * edgeDensity);
 }
 
+void PowerLawGenerator::beginInstance() {
+    weights.assign(V);
+    for (int v = 0; v < V; v++) {
+        if (weighting == PREFERENTIAL_ATTACHMENT) weights.add(v, 1); // no edges yet
+        else {
+            // fixed-point weights, the heaviest vertex gets 2^40
+            double w = ldexp(1.0, 40) / pow(v + 1, exponent);
+            weights.add(v, max(1LL, llround(w)));
+        }
+    }
+}
+
+int PowerLawGenerator::sampleWeightedVertex() {
+    return weights.findByPrefix(uniformInt(0, weights.total() - 1));
+}
+
+void PowerLawGenerator::updateDegree(int v, int delta) {
+    if (weighting == PREFERENTIAL_ATTACHMENT) weights.add(v, delta);
+}
+
+vector<pair<int,int>> PowerLawGenerator::purgeRandomEdges(BoundedArbGraph &graph, int count) {
+    vector<pair<int,int>> purged = deleteUniformEdges(graph, count);
+    onEdgesPurged(purged);
+    return purged;
+}
+
+void PowerLawGenerator::onEdgesPurged(const vector<pair<int,int>> &purged) {
+    for (const pair<int,int> &edge : purged) {
+        updateDegree(edge.first, -1);
+        updateDegree(edge.second, -1);
+    }
+}
+
+pair<int,int> PowerLawGenerator::insertRandomEdge(BoundedArbGraph &graph) {
+    int forestIndex, endpointFirst, endpointSecond;
+    int attempts = 0;
+    do {
+        forestIndex = forestDistr(engine);
+        if (attempts++ < WEIGHTED_ATTEMPTS) {
+            endpointFirst = sampleWeightedVertex();
+            endpointSecond = sampleWeightedVertex();
+        }
+        else {
+            endpointFirst = vertexDistr(engine);
+            endpointSecond = vertexDistr(engine);
+        }
+    } while (!graph.insertEdge(forestIndex, endpointFirst, endpointSecond));
+    
+    updateDegree(endpointFirst, +1);
+    updateDegree(endpointSecond, +1);
+    if (endpointFirst > endpointSecond) swap(endpointFirst, endpointSecond);
+    return make_pair(endpointFirst, endpointSecond);
+}
+
+pair<int,int> PowerLawGenerator::deleteRandomEdge(BoundedArbGraph &graph) {
+    int removedEdgeIndex = uniformInt(0, graph.getEdgeCount()-1);
+    pair<int,int> edgeRemoved = graph.getEdge(removedEdgeIndex);
+    graph.deleteEdge(edgeRemoved.first, edgeRemoved.second);
+    updateDegree(edgeRemoved.first, -1);
+    updateDegree(edgeRemoved.second, -1);
+    return edgeRemoved;
+}
+
+float PowerLawGenerator::getInsertProbability(BoundedArbGraph &graph) {
+    float currentDensity = graph.getEdgeCount() / (alpha * (V-1.));
+    if (currentDensity <= edgeDensity) {
+        return 1 - currentDensity / (2 * edgeDensity);
+    }
+    else return (1 - currentDensity) / (2 - 2 * edgeDensity);
+}
+
+void TemporalGenerator::beginInstance() {
+    insertionQueue.clear();
+    expiryQueue = decltype(expiryQueue)();
+    liveStamps.clear();
+    clock = 0;
+}
+
+/* Purge deletions count as operations, as the other deletions do. */
+void TemporalGenerator::onEdgesPurged(const vector<pair<int,int>> &purged) {
+    for (const pair<int,int> &edge : purged) liveStamps.erase(packEdge(edge));
+    clock += purged.size();
+}
+
+unsigned long long TemporalGenerator::packEdge(pair<int,int> edge) {
+    return (static_cast<unsigned long long>(edge.first) << 32) | (unsigned int)edge.second;
+}
+
+/* Is the entry the one of the current insertion of its edge? */
+bool TemporalGenerator::isLive(const QueuedEdge &entry) {
+    auto stamp = liveStamps.find(packEdge(entry.edge));
+    return stamp != liveStamps.end() && stamp->second == entry.stamp;
+}
+
+/* pops queue entries of purged edges from the front of the queue */
+void TemporalGenerator::discardPurgedEntries() {
+    if (order == OLDEST_FIRST) {
+        while (!insertionQueue.empty() && !isLive(insertionQueue.front())) {
+            insertionQueue.pop_front();
+        }
+    }
+    else {
+        while (!expiryQueue.empty() && !isLive(expiryQueue.top())) expiryQueue.pop();
+    }
+}
+
+pair<int,int> TemporalGenerator::insertRandomEdge(BoundedArbGraph &graph) {
+    int forestIndex, endpointFirst, endpointSecond;
+    do {
+        forestIndex = forestDistr(engine);
+        endpointFirst = vertexDistr(engine);
+        endpointSecond = vertexDistr(engine);
+    } while (!graph.insertEdge(forestIndex, endpointFirst, endpointSecond));
+    if (endpointFirst > endpointSecond) swap(endpointFirst, endpointSecond);
+    
+    pair<int,int> edgeInserted = make_pair(endpointFirst, endpointSecond);
+    liveStamps[packEdge(edgeInserted)] = clock;
+    if (order == OLDEST_FIRST) insertionQueue.push_back({0, clock, edgeInserted});
+    else expiryQueue.push({clock + 1 + lifetimeDistr(engine), clock, edgeInserted});
+    clock++;
+    return edgeInserted;
+}
+
+pair<int,int> TemporalGenerator::deleteRandomEdge(BoundedArbGraph &graph) {
+    discardPurgedEntries();
+    pair<int,int> edgeRemoved;
+    if (order == OLDEST_FIRST) {
+        edgeRemoved = insertionQueue.front().edge;
+        insertionQueue.pop_front();
+    }
+    else {
+        edgeRemoved = expiryQueue.top().edge;
+        expiryQueue.pop();
+    }
+    liveStamps.erase(packEdge(edgeRemoved));
+    graph.deleteEdge(edgeRemoved.first, edgeRemoved.second);
+    clock++;
+    return edgeRemoved;
+}
+
+float TemporalGenerator::getInsertProbability(BoundedArbGraph &graph) {
+    // an expired edge has to go first
+    discardPurgedEntries();
+    if (order == EARLIEST_EXPIRY && !expiryQueue.empty() &&
+        expiryQueue.top().expiry <= clock) return 0;
+    
+    float currentDensity = graph.getEdgeCount() / (alpha * (V-1.));
+    if (currentDensity <= edgeDensity) {
+        return 1 - currentDensity / (2 * edgeDensity);
+    }
+    else return (1 - currentDensity) / (2 - 2 * edgeDensity);
+}
+
+void AdversarialGenerator::beginInstance() {
+    for (pair<int,int> &edge : orientation.getAllEdges()) {
+        orientation.removeEdge(edge.first, edge.second);
+    }
+    byOutdegree.clear();
+    for (int v = 0; v < V; v++) byOutdegree.emplace(0, v);
+}
+
+void AdversarialGenerator::onEdgesPurged(const vector<pair<int,int>> &purged) {
+    for (const pair<int,int> &edge : purged) removeOriented(edge.first, edge.second);
+}
+
+void AdversarialGenerator::orientGreedily(int va, int vb) {
+    if (orientation.getOutdegree(vb) < orientation.getOutdegree(va)) swap(va, vb);
+    byOutdegree.erase(make_pair(orientation.getOutdegree(va), va));
+    orientation.orientEdge(va, vb);
+    byOutdegree.emplace(orientation.getOutdegree(va), va);
+}
+
+void AdversarialGenerator::removeOriented(int va, int vb) {
+    if (!orientation.isOriented(va, vb)) swap(va, vb);
+    byOutdegree.erase(make_pair(orientation.getOutdegree(va), va));
+    orientation.removeEdge(va, vb);
+    byOutdegree.emplace(orientation.getOutdegree(va), va);
+}
+
+pair<int,int> AdversarialGenerator::insertRandomEdge(BoundedArbGraph &graph) {
+    vector<int> candidates;
+    for (auto iter = byOutdegree.rbegin(); iter != byOutdegree.rend() &&
+         (int)candidates.size() < CANDIDATES; iter++) {
+        candidates.push_back(iter->second);
+    }
+    
+    int forestIndex, endpointFirst, endpointSecond;
+    int attempts = 0;
+    do {
+        forestIndex = forestDistr(engine);
+        if (attempts++ < TARGETED_ATTEMPTS) {
+            endpointFirst = candidates[uniformInt(0, candidates.size()-1)];
+            endpointSecond = candidates[uniformInt(0, candidates.size()-1)];
+        }
+        else {
+            endpointFirst = vertexDistr(engine);
+            endpointSecond = vertexDistr(engine);
+        }
+    } while (!graph.insertEdge(forestIndex, endpointFirst, endpointSecond));
+    
+    if (endpointFirst > endpointSecond) swap(endpointFirst, endpointSecond);
+    orientGreedily(endpointFirst, endpointSecond);
+    return make_pair(endpointFirst, endpointSecond);
+}
+
+pair<int,int> AdversarialGenerator::deleteRandomEdge(BoundedArbGraph &graph) {
+    // the least loaded vertex with an outgoing edge (one exists, as the graph is not empty)
+    int v = byOutdegree.lower_bound(make_pair(1, -1))->second;
+    vector<int> outNeighbours = orientation.getOutNeighbours(v);
+    int u = outNeighbours[uniformInt(0, outNeighbours.size()-1)];
+    
+    graph.deleteEdge(v, u);
+    removeOriented(v, u);
+    return make_pair(min(u, v), max(u, v));
+}
+
+float AdversarialGenerator::getInsertProbability(BoundedArbGraph &graph) {
+    float currentDensity = graph.getEdgeCount() / (alpha * (V-1.));
+    if (currentDensity <= edgeDensity) {
+        return 1 - currentDensity / (2 * edgeDensity);
+    }
+    else return (1 - currentDensity) / (2 - 2 * edgeDensity);
+}
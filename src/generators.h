@@ -4,11 +4,28 @@
 #include <iostream>
 #include <vector>
 #include <random>
+#include <memory>
+#include <deque>
+#include <queue>
+#include <functional>
+#include <map>
+#include <unordered_map>
 #include "graphs.h"
+#include "random-engine.h"
 using std::string;
 using std::vector;
 using std::pair;
 using std::random_device;
+using std::unique_ptr;
+using std::uniform_real_distribution;
+using std::uniform_int_distribution;
+using std::geometric_distribution;
+using std::deque;
+using std::priority_queue;
+using std::greater;
+using std::function;
+using std::map;
+using std::unordered_map;
 
 
 enum OperationType { INSERT, DELETE };
@@ -18,6 +35,7 @@ struct Command {
     pair<int,int> nodes;
     
     string printCommand();
+    void writeCommand(std::ostream &outputStream) const; // printCommand without a temporary
 };
 
 struct OrientationProblemInstance {
@@ -29,6 +47,14 @@ struct OrientationProblemInstance {
     void printSequence(std::ostream &outputStream);
 };
 
+/* What a purge phase removes:
+   RANDOM_EDGES     - random edges, as chosen by the generator; their number
+                      is uniform in [0, |E|/2]
+   WHOLE_COMPONENTS - every edge of the connected component (of the whole
+                      graph) containing a uniformly random edge, as when
+                      a tenant gets evicted */
+enum PurgeMode { RANDOM_EDGES, WHOLE_COMPONENTS };
+
 /* Creates various instances of the graph orientation problem.
    The Generator inserts a new edge with certain probability, otherwise
    removes one existing edge. To prevent too many edges in the graph,
@@ -38,16 +64,62 @@ class Generator {
     protected:
         const int V;
         const int alpha; // arboricity upper bound
-        std::mt19937 engine; // Mersenne twister engine
+        RandomEngine engine; // Mersenne twister by default
+        PurgeMode purgeMode; // RANDOM_EDGES by default
+        
+        /* Distributions are kept between calls; those with varying
+           bounds are used through uniformInt. */
+        uniform_real_distribution<> unitDistr;
+        uniform_int_distribution<> forestDistr;
+        uniform_int_distribution<> vertexDistr;
+        uniform_int_distribution<long long> rangeDistr;
+        
+        // uniformly random integer from [low, high]
+        long long uniformInt(long long low, long long high) {
+            return rangeDistr(engine, decltype(rangeDistr)::param_type(low, high));
+        }
+        
+        /* Deletes "count" distinct, uniformly random edges in a single
+           BoundedArbGraph::deleteEdges call and returns them in a uniformly
+           random order. */
+        vector<pair<int,int>> deleteUniformEdges(BoundedArbGraph&, int count);
     
     public:
         Generator(int V, int alpha, random_device &rd);
+        virtual ~Generator() {}
         
         void setSeed(long long seed);
         
+        /* Switches the random engine backend; the current seed is kept. */
+        void setEngineType(EngineType type) { engine.setType(type); }
+        
+        void setPurgeMode(PurgeMode mode) { purgeMode = mode; }
+        
         // "sequenceLen" is the desired number of operations
         OrientationProblemInstance generateInstance(int sequenceLen);
         
+        /* Generates the same sequence as generateInstance, but hands every
+           Command to "emit" instead of storing it, so that instances much
+           larger than the available memory can be produced. */
+        void generateSequence(long long sequenceLen, const function<void(const Command&)> &emit);
+        
+        /* Writes a generated instance straight to the trace stream,
+           in the format of OrientationProblemInstance::printSequence. */
+        void streamInstance(long long sequenceLen, std::ostream &traceStream);
+        
+        /* Generates "count" instances in parallel. Instance i is produced by
+           a copy of this generator with its own random stream, derived from
+           masterSeed and i, so the result does not depend on "threads" and
+           every instance can be reproduced on its own (see seedStream). */
+        vector<OrientationProblemInstance> generateInstances(int count, int sequenceLen,
+            unsigned long long masterSeed, int threads);
+        
+        /* Seeds the engine with the stream-th random stream of masterSeed. */
+        void seedStream(unsigned long long masterSeed, unsigned long long stream);
+        
+        // polymorphic copy (including the engine state)
+        virtual unique_ptr<Generator> clone() const = 0;
+        
         /* Every Generator needs to provide custom implementations
             of the "insertRandomEdge" and "deleteRandomEdge" methods. */
         virtual pair<int,int> insertRandomEdge(BoundedArbGraph&) = 0;
@@ -57,8 +129,39 @@ class Generator {
            on the current graph structure. */
         virtual float getInsertProbability(BoundedArbGraph&) = 0;
         virtual float getPurgeProbability(BoundedArbGraph&) = 0;
+        
+        /* Deletes "count" edges of a RANDOM_EDGES purge and returns them in
+           the order of deletion. By default deleteRandomEdge is called
+           repeatedly; generators deleting uniformly use deleteUniformEdges. */
+        virtual vector<pair<int,int>> purgeRandomEdges(BoundedArbGraph&, int count);
+        
+        /* Called after a WHOLE_COMPONENTS purge deleted the given edges
+           (bypassing deleteRandomEdge), for generators tracking the graph. */
+        virtual void onEdgesPurged(const vector<pair<int,int>>&) {}
+        
+        /* Should the generated graphs keep per-forest component indexes
+           (see BoundedArbGraph::getCrossPair)? */
+        virtual bool usesComponentIndex() { return false; }
+        
+        /* Called before the first operation of every instance, so that
+           generators may reset state tied to the (initially empty) graph. */
+        virtual void beginInstance() {}
+    
+    private:
+        /* Deletes the edges of the component containing a random edge, in BFS
+           order, stopping after maxCount edges; returns the deleted edges. */
+        vector<pair<int,int>> purgeComponent(BoundedArbGraph&, long long maxCount);
 };
 
+/* How new edges are sampled:
+   REJECTION_SAMPLING       - draw (forest, u, v) until the insertion succeeds;
+                              slows down considerably as forests fill up
+   CROSS_COMPONENT_SAMPLING - draw a pair of vertices from different components
+                              of a forest directly, retrying only when the edge
+                              is present in another forest
+   Both modes sample uniformly from the same set of insertable edges. */
+enum EdgeSampling { REJECTION_SAMPLING, CROSS_COMPONENT_SAMPLING };
+
 /* Both new edge endpoints are sampled from a uniform distribution.
    Similarly, every edge in the graph has equal probability to be deleted.
    edgeDensity is the expected fraction of edges present in the graph.
@@ -67,17 +170,29 @@ class UniformDistrGenerator : public Generator {
     private:
         const float edgeDensity;
         const float purgeProb;
+        const EdgeSampling sampling;
     
     public:
         UniformDistrGenerator(int V, int alpha, random_device &rd,
-        float edgeDensity, float purgeProb) :
-            Generator(V, alpha, rd), edgeDensity(edgeDensity), purgeProb(purgeProb) {}
+        float edgeDensity, float purgeProb, EdgeSampling sampling = REJECTION_SAMPLING) :
+            Generator(V, alpha, rd), edgeDensity(edgeDensity), purgeProb(purgeProb),
+            sampling(sampling) {}
     
     private:
         pair<int,int> insertRandomEdge(BoundedArbGraph&);
         pair<int,int> deleteRandomEdge(BoundedArbGraph&);
         float getInsertProbability(BoundedArbGraph&);
         float getPurgeProbability(BoundedArbGraph&) { return purgeProb; }
+        bool usesComponentIndex() { return sampling == CROSS_COMPONENT_SAMPLING; }
+        vector<pair<int,int>> purgeRandomEdges(BoundedArbGraph &graph, int count) {
+            return deleteUniformEdges(graph, count);
+        }
+        
+        unique_ptr<Generator> clone() const {
+            return unique_ptr<Generator>(new UniformDistrGenerator(*this));
+        }
+        
+        pair<int,int> insertCrossComponentEdge(BoundedArbGraph&);
 };
 
 /* Uses a geometric distribution to select one of the endpoints.
@@ -88,18 +203,180 @@ class GeomDistrGenerator : public Generator {
         const float edgeDensity;
         const float purgeProb;
         const float succProb; // distribution parameter (success probability)
+        geometric_distribution<> geomDistr;
     
     public:
         GeomDistrGenerator(int V, int alpha, random_device &rd,
         float edgeDensity, float purgeProb, float succProb) :
             Generator(V, alpha, rd), edgeDensity(edgeDensity),
-            purgeProb(purgeProb), succProb(succProb) {}
+            purgeProb(purgeProb), succProb(succProb), geomDistr(succProb) {}
+    
+    private:
+        pair<int,int> insertRandomEdge(BoundedArbGraph&);
+        pair<int,int> deleteRandomEdge(BoundedArbGraph&);
+        float getInsertProbability(BoundedArbGraph&);
+        float getPurgeProbability(BoundedArbGraph&) { return purgeProb; }
+        vector<pair<int,int>> purgeRandomEdges(BoundedArbGraph &graph, int count) {
+            return deleteUniformEdges(graph, count);
+        }
+        
+        unique_ptr<Generator> clone() const {
+            return unique_ptr<Generator>(new GeomDistrGenerator(*this));
+        }
+};
+
+/* Endpoint weights of the PowerLawGenerator:
+   PREFERENTIAL_ATTACHMENT - degree of the vertex plus one (changes over time)
+   ZIPF                    - 1 / (v+1)^exponent for vertex v (fixed) */
+enum EndpointWeighting { PREFERENTIAL_ATTACHMENT, ZIPF };
+
+/* Heavy-tailed edge streams: both endpoints of a new edge are drawn
+   with probability proportional to their weights, kept in a Fenwick tree
+   (O(log |V|) per draw and per degree update). Every edge in the graph
+   has equal probability to be deleted; edgeDensity and purgeProb play
+   the same role as in UniformDistrGenerator. */
+class PowerLawGenerator : public Generator {
+    private:
+        const float edgeDensity;
+        const float purgeProb;
+        const EndpointWeighting weighting;
+        const double exponent;          // Zipf exponent (ZIPF only)
+        FenwickTree<long long> weights; // integer weights of all vertices
+        
+        /* After this many rejected weighted draws the endpoints of the
+           current edge are drawn uniformly, so that saturated hubs
+           cannot stall the generator. */
+        static const int WEIGHTED_ATTEMPTS = 64;
+    
+    public:
+        PowerLawGenerator(int V, int alpha, random_device &rd, float edgeDensity,
+        float purgeProb, EndpointWeighting weighting, double exponent = 1.0) :
+            Generator(V, alpha, rd), edgeDensity(edgeDensity), purgeProb(purgeProb),
+            weighting(weighting), exponent(exponent), weights(V) {}
     
     private:
         pair<int,int> insertRandomEdge(BoundedArbGraph&);
         pair<int,int> deleteRandomEdge(BoundedArbGraph&);
         float getInsertProbability(BoundedArbGraph&);
         float getPurgeProbability(BoundedArbGraph&) { return purgeProb; }
+        void beginInstance();
+        vector<pair<int,int>> purgeRandomEdges(BoundedArbGraph&, int count);
+        void onEdgesPurged(const vector<pair<int,int>>&);
+        
+        int sampleWeightedVertex();
+        void updateDegree(int v, int delta);
+        
+        unique_ptr<Generator> clone() const {
+            return unique_ptr<Generator>(new PowerLawGenerator(*this));
+        }
+};
+
+/* Which edge the TemporalGenerator deletes:
+   OLDEST_FIRST    - the edge inserted first (FIFO)
+   EARLIEST_EXPIRY - the edge whose time-to-live runs out first; lifetimes
+                     are geometric, measured in operations since insertion */
+enum DeletionOrder { OLDEST_FIRST, EARLIEST_EXPIRY };
+
+/* Edges are inserted uniformly at random (as in UniformDistrGenerator),
+   but deletions follow the insertion timestamps instead of being uniform.
+   OLDEST_FIRST takes O(1) per operation. With EARLIEST_EXPIRY, deletions
+   are forced as soon as the earliest edge expires, so that lifetimes
+   really follow the distribution; expiry times sit in a binary heap. */
+class TemporalGenerator : public Generator {
+    private:
+        const float edgeDensity;
+        const float purgeProb;
+        const DeletionOrder order;
+        geometric_distribution<> lifetimeDistr;
+        
+        /* Queue entry of an inserted edge. The stamp (clock at insertion)
+           identifies the insertion, as an edge may be deleted by a purge
+           and inserted again before its old entry leaves the queue. */
+        struct QueuedEdge {
+            long long expiry; // EARLIEST_EXPIRY only
+            long long stamp;
+            pair<int,int> edge;
+            
+            bool operator>(const QueuedEdge &ref) const {
+                if (expiry != ref.expiry) return expiry > ref.expiry;
+                if (edge != ref.edge) return edge > ref.edge;
+                return stamp > ref.stamp;
+            }
+        };
+        deque<QueuedEdge> insertionQueue; // OLDEST_FIRST only
+        priority_queue<QueuedEdge, vector<QueuedEdge>, greater<QueuedEdge>> expiryQueue;
+        long long clock; // operations performed in the current instance
+        
+        /* Stamp of the insertion of every edge in the graph (packed edge ->
+           stamp). Entries of edges deleted by a WHOLE_COMPONENTS purge no
+           longer match it and are skipped (lazily) when they reach the front. */
+        unordered_map<unsigned long long, long long> liveStamps;
+        static unsigned long long packEdge(pair<int,int> edge);
+        bool isLive(const QueuedEdge &entry);
+        void discardPurgedEntries();
+    
+    public:
+        TemporalGenerator(int V, int alpha, random_device &rd, float edgeDensity,
+        float purgeProb, DeletionOrder order, float meanLifetime = 1) :
+            Generator(V, alpha, rd), edgeDensity(edgeDensity), purgeProb(purgeProb),
+            order(order), lifetimeDistr(1 / (meanLifetime + 1.)), clock(0) {}
+    
+    private:
+        pair<int,int> insertRandomEdge(BoundedArbGraph&);
+        pair<int,int> deleteRandomEdge(BoundedArbGraph&);
+        float getInsertProbability(BoundedArbGraph&);
+        float getPurgeProbability(BoundedArbGraph&) { return purgeProb; }
+        void beginInstance();
+        void onEdgesPurged(const vector<pair<int,int>>&);
+        
+        unique_ptr<Generator> clone() const {
+            return unique_ptr<Generator>(new TemporalGenerator(*this));
+        }
+};
+
+/* Adaptive generator playing against an online greedy orientation, which
+   orients every new edge away from the endpoint with the smaller outdegree.
+   The generator keeps that orientation up to date (ForestOrientation) along
+   with the vertices ordered by outdegree, and tries to raise the maximum:
+   new edges join vertices of the largest outdegrees, while deletions take
+   an outgoing edge of the least loaded vertex that has one.
+   Every step costs O(log |V|) plus a bounded number of insertion attempts. */
+class AdversarialGenerator : public Generator {
+    private:
+        const float edgeDensity;
+        const float purgeProb;
+        ForestOrientation orientation;  // state of the greedy strategy
+        set<pair<int,int>> byOutdegree; // pairs (outdegree, v)
+        
+        // new edges are drawn among this many vertices of the largest outdegrees
+        static const int CANDIDATES = 8;
+        // number of targeted insertion attempts before falling back to uniform ones
+        static const int TARGETED_ATTEMPTS = 32;
+    
+    public:
+        AdversarialGenerator(int V, int alpha, random_device &rd,
+        float edgeDensity, float purgeProb) :
+            Generator(V, alpha, rd), edgeDensity(edgeDensity), purgeProb(purgeProb),
+            orientation(V) {}
+        
+        /* maximum outdegree of the greedy orientation of the current graph */
+        int getGreedyMaxOutdegree() { return prev(byOutdegree.end())->first; }
+    
+    private:
+        pair<int,int> insertRandomEdge(BoundedArbGraph&);
+        pair<int,int> deleteRandomEdge(BoundedArbGraph&);
+        float getInsertProbability(BoundedArbGraph&);
+        float getPurgeProbability(BoundedArbGraph&) { return purgeProb; }
+        void beginInstance();
+        void onEdgesPurged(const vector<pair<int,int>>&);
+        
+        /* updates the greedy orientation (and outdegree order) */
+        void orientGreedily(int va, int vb);
+        void removeOriented(int va, int vb);
+        
+        unique_ptr<Generator> clone() const {
+            return unique_ptr<Generator>(new AdversarialGenerator(*this));
+        }
 };
 
 #endif
@@ -1,8 +1,12 @@
 #include "graphs.h"
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 using std::string;
 using std::swap;
+using std::sort;
+using std::set_difference;
+using std::back_inserter;
 
 
 bool Forest::isAdjacent(int va, int vb) {
@@ -41,6 +45,32 @@ void Forest::deleteEdge(int va, int vb) {
     }
 }
 
+/* Deletes many edges at once (all have to be present). A large
+   batch rebuilds the forest from the remaining edges in linear time. */
+void Forest::deleteEdges(vector< pair<int,int> > removed) {
+    if ((long long)removed.size() * REBUILD_RATIO < edgeCount) {
+        for (pair<int,int> &edge : removed) deleteEdge(edge.first, edge.second);
+        return;
+    }
+    
+    for (pair<int,int> &edge : removed) {
+        if (edge.first > edge.second) swap(edge.first, edge.second);
+    }
+    sort(removed.begin(), removed.end());
+    vector< pair<int,int> > current = edges.collectKeys();
+    sort(current.begin(), current.end());
+    
+    vector< pair<int,int> > remaining;
+    remaining.reserve(current.size());
+    set_difference(current.begin(), current.end(), removed.begin(), removed.end(),
+                   back_inserter(remaining));
+    assert (remaining.size() + removed.size() == current.size());
+    
+    edges.assignSorted(remaining);
+    links.rebuild(remaining);
+    edgeCount = remaining.size();
+}
+
 // outputs DOT description (graphviz-friendly format)
 void Forest::printDescription(ostream &outputStream) {
     outputStream << "graph {" << "\n";
@@ -64,35 +94,91 @@ vector<pair<int,int>> Forest::getAllEdges() {
 }
 
 bool BoundedArbGraph::isAdjacent(int va, int vb) {
-    bool adjacent = false;
-    for (Forest &f : forests) adjacent |= f.isAdjacent(va, vb);
-    return adjacent;
+    return edgeOwners.count(packEdge(va, vb)) > 0;
 }
 
 /* returns true iff insertion was successful */
 bool BoundedArbGraph::insertEdge(int forestIndex, int va, int vb) {
     if (isAdjacent(va, vb)) return false;
-    else return forests[forestIndex].insertEdge(va, vb);
+    if (!forests[forestIndex].insertEdge(va, vb)) return false;
+    if (!components.empty()) components[forestIndex].link(va, vb);
+    forestEdgeCounts.add(forestIndex, +1);
+    edgeCount++;
+    edgeOwners.emplace(packEdge(va, vb), forestIndex);
+    return true;
 }
 
 void BoundedArbGraph::deleteEdge(int va, int vb) {
-    for (Forest &f : forests) f.deleteEdge(va, vb);
+    auto owner = edgeOwners.find(packEdge(va, vb));
+    if (owner == edgeOwners.end()) return; // edge not present
+    
+    const int f = owner->second;
+    edgeOwners.erase(owner);
+    forests[f].deleteEdge(va, vb);
+    if (!components.empty()) components[f].cut(va, vb);
+    forestEdgeCounts.add(f, -1);
+    edgeCount--;
+}
+
+/* Deletes many edges at once (all have to be present), grouped
+   by forest; see Forest::deleteEdges. */
+void BoundedArbGraph::deleteEdges(const vector< pair<int,int> > &removed) {
+    vector< vector< pair<int,int> > > removedByForest(alpha);
+    for (const pair<int,int> &edge : removed) {
+        auto owner = edgeOwners.find(packEdge(edge.first, edge.second));
+        assert (owner != edgeOwners.end());
+        removedByForest[owner->second].push_back(edge);
+        edgeOwners.erase(owner);
+    }
+    
+    for (int f = 0; f < alpha; f++) {
+        if (removedByForest[f].empty()) continue;
+        forests[f].deleteEdges(removedByForest[f]);
+        if (!components.empty()) {
+            for (pair<int,int> &edge : removedByForest[f]) {
+                components[f].cut(edge.first, edge.second);
+            }
+        }
+        forestEdgeCounts.add(f, -(int)removedByForest[f].size());
+    }
+    edgeCount -= removed.size();
+}
+
+// forest by forest
+vector< pair<int,int> > BoundedArbGraph::getAllEdges() {
+    vector< pair<int,int> > result;
+    result.reserve(edgeCount);
+    for (Forest &forest : forests) {
+        vector< pair<int,int> > forestEdges = forest.getAllEdges();
+        result.insert(result.end(), forestEdges.begin(), forestEdges.end());
+    }
+    return result;
+}
+
+// order of endpoints is irrelevant
+unsigned long long BoundedArbGraph::packEdge(int va, int vb) {
+    if (va > vb) swap(va, vb);
+    return (static_cast<unsigned long long>(va) << 32) | static_cast<unsigned int>(vb);
+}
+
+/* Cross-component vertex pairs of a forest, i.e. candidates for
+   insertion into that forest. Requires indexComponents. */
+long long BoundedArbGraph::getCrossPairCount(int forestIndex) {
+    assert (!components.empty());
+    return components[forestIndex].getCrossPairCount();
 }
 
-int BoundedArbGraph::getEdgeCount() {
-    int totalEdges = 0;
-    for (Forest &f : forests) totalEdges += f.getEdgeCount();
-    return totalEdges;
+pair<int,int> BoundedArbGraph::getCrossPair(int forestIndex, long long rank) {
+    assert (!components.empty());
+    return components[forestIndex].getCrossPair(rank);
 }
 
 /* getEdge(i) returns a pair containing i-th edge endpoints
-   (numbering starts from 0) */
+   (numbering starts from 0); edges are numbered forest by forest */
 pair<int,int> BoundedArbGraph::getEdge(int index) {
-    assert (0 <= index && index < getEdgeCount());
-    for (Forest &f : forests) {
-        if (index - f.getEdgeCount() >= 0) index -= f.getEdgeCount();
-        else return f.getEdge(index);
-    }
+    assert (0 <= index && index < edgeCount);
+    int forestIndex = forestEdgeCounts.findByPrefix(index);
+    return forests[forestIndex].getEdge(index - forestEdgeCounts.prefixSum(forestIndex));
 }
 
 /* outputs DOT description where each forest has a unique color */
@@ -115,6 +201,126 @@ void BoundedArbGraph::printDescription(ostream &outputStream) {
     outputStream << "}" << "\n";
 }
 
+ComponentIndex::ComponentIndex(int V) : V(V), componentOf(V), positionOf(V, 0),
+    members(V), adjacency(V), visitMark(V, 0), visitRound(0),
+    crossPairs(V), sizes(V) {
+    // initially every vertex forms a separate component
+    for (int v = 0; v < V; v++) {
+        componentOf[v] = v;
+        members[v].push_back(v);
+        crossPairs.add(v, V - 1);
+        sizes.add(v, 1);
+    }
+}
+
+/* va and vb must be in different components */
+void ComponentIndex::link(int va, int vb) {
+    int ca = componentOf[va];
+    int cb = componentOf[vb];
+    assert (ca != cb);
+    if (members[ca].size() < members[cb].size()) swap(ca, cb);
+    
+    // merge the smaller component (cb) into the larger one (ca)
+    const int oldSize = members[ca].size();
+    const int movedSize = members[cb].size();
+    setComponentSize(cb, 0);
+    while (!members[cb].empty()) moveVertex(members[cb].back(), ca);
+    setComponentSize(ca, oldSize + movedSize);
+    freeIds.push_back(cb);
+    
+    adjacency[va].push_back(vb);
+    adjacency[vb].push_back(va);
+}
+
+/* (va, vb) must be an edge of the forest */
+void ComponentIndex::cut(int va, int vb) {
+    removeNeighbour(va, vb);
+    removeNeighbour(vb, va);
+    
+    /* Explore both resulting trees alternately, one vertex at a time,
+       and stop as soon as one of them is exhausted. */
+    visitRound++;
+    vector<int> sides[2] = { {va}, {vb} };
+    int processed[2] = {0, 0};
+    visitMark[va] = visitMark[vb] = visitRound;
+    
+    int smaller = -1;
+    while (smaller == -1) {
+        for (int side = 0; side < 2 && smaller == -1; side++) {
+            if (processed[side] == sides[side].size()) {
+                smaller = side;
+                break;
+            }
+            int v = sides[side][processed[side]++];
+            for (int neighbour : adjacency[v]) {
+                if (visitMark[neighbour] == visitRound) continue;
+                visitMark[neighbour] = visitRound;
+                sides[side].push_back(neighbour);
+            }
+        }
+    }
+    
+    const int oldComponent = componentOf[va];
+    const int oldSize = members[oldComponent].size();
+    const int movedSize = sides[smaller].size();
+    const int newComponent = freeIds.back();
+    freeIds.pop_back();
+    
+    for (int v : sides[smaller]) moveVertex(v, newComponent);
+    setComponentSize(oldComponent, oldSize - movedSize);
+    setComponentSize(newComponent, movedSize);
+}
+
+// returns the cross-component pair of the given rank (from 0)
+pair<int,int> ComponentIndex::getCrossPair(long long rank) {
+    assert (0 <= rank && rank < getCrossPairCount());
+    
+    // the first vertex, from component c
+    const int c = crossPairs.findByPrefix(rank);
+    rank -= crossPairs.prefixSum(c);
+    const int size = members[c].size();
+    const int u = members[c][rank / (V - size)];
+    
+    // the second vertex, ranked among vertices outside of c
+    int outsideRank = rank % (V - size);
+    if (outsideRank >= sizes.prefixSum(c)) outsideRank += size;
+    const int d = sizes.findByPrefix(outsideRank);
+    const int v = members[d][outsideRank - sizes.prefixSum(d)];
+    return pair<int,int>(u, v);
+}
+
+void ComponentIndex::moveVertex(int v, int target) {
+    // swap-remove from the current members list
+    vector<int> &source = members[componentOf[v]];
+    int last = source.back();
+    source[positionOf[v]] = last;
+    positionOf[last] = positionOf[v];
+    source.pop_back();
+    
+    componentOf[v] = target;
+    positionOf[v] = members[target].size();
+    members[target].push_back(v);
+}
+
+/* Updates the Fenwick trees; members lists are maintained separately. */
+void ComponentIndex::setComponentSize(int component, int newSize) {
+    int oldSize = sizes.prefixSum(component + 1) - sizes.prefixSum(component);
+    sizes.add(component, newSize - oldSize);
+    crossPairs.add(component, (long long)newSize * (V - newSize) -
+                              (long long)oldSize * (V - oldSize));
+}
+
+void ComponentIndex::removeNeighbour(int v, int neighbour) {
+    vector<int> &list = adjacency[v];
+    for (int &x : list) {
+        if (x == neighbour) {
+            x = list.back();
+            list.pop_back();
+            return;
+        }
+    }
+}
+
 /* returns the number of edges oriented from v */
 int ForestOrientation::getOutdegree(int v) {
     assert (0 <= v && v < V);
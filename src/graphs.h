@@ -5,13 +5,17 @@
 #include <vector>
 #include <utility>
 #include <set>
+#include <unordered_map>
 #include "avl-tree.h"
 #include "avl-tree.cpp"
 #include "link-cut-tree.h"
+#include "fenwick-tree.h"
+#include "fenwick-tree.cpp"
 using std::vector;
 using std::ostream;
 using std::pair;
 using std::set;
+using std::unordered_map;
 
 
 // undirected graph of arboricity one
@@ -23,11 +27,21 @@ class Forest {
         LinkCutTrees links;
     
     public:
+        /* deleteEdges rebuilds the forest once the batch reaches
+           1/REBUILD_RATIO of its edges (measured break-even point) */
+        static const int REBUILD_RATIO = 5;
+        
         Forest(int V) : V(V), edgeCount(0), edges(), links(V) {}
         
         bool isAdjacent(int va, int vb);
         bool insertEdge(int va, int vb); // returns true iff insertion was successful
         void deleteEdge(int va, int vb);
+        
+        /* Deletes many edges at once (all have to be present). A large
+           batch rebuilds the forest from the remaining edges in linear time
+           instead of paying an AVL removal and a link-cut cut per edge. */
+        void deleteEdges(vector< pair<int,int> > removed);
+        
         void printDescription(ostream &outputStream); // description in DOT format
         pair<int,int> getEdge(int index); // edge numbering starts from 0
         vector< pair<int,int> > getAllEdges();
@@ -36,6 +50,42 @@ class Forest {
 };
 
 
+/* Connected components of a forest, kept explicitly so that an ordered pair
+   of vertices lying in different components can be selected by its rank.
+   Linking merges the smaller component into the larger one; cutting moves
+   the smaller of the two resulting trees (found by interleaved BFS). */
+class ComponentIndex {
+    private:
+        const int V;
+        vector<int> componentOf;       // component id of every vertex
+        vector<int> positionOf;        // position of a vertex in its members list
+        vector<vector<int>> members;   // vertices of every component
+        vector<int> freeIds;           // unused component ids
+        vector<vector<int>> adjacency; // forest edges
+        vector<int> visitMark;         // BFS bookkeeping
+        int visitRound;
+        FenwickTree<long long> crossPairs; // size * (V - size) for every component
+        FenwickTree<int> sizes;            // size of every component
+    
+    public:
+        ComponentIndex(int V);
+        
+        void link(int va, int vb);  // va and vb must be in different components
+        void cut(int va, int vb);   // (va, vb) must be an edge of the forest
+        
+        // number of ordered pairs (u, v) with u and v in different components
+        long long getCrossPairCount() { return crossPairs.total(); }
+        
+        // returns the cross-component pair of the given rank (from 0)
+        pair<int,int> getCrossPair(long long rank);
+    
+    private:
+        void moveVertex(int v, int target);
+        void setComponentSize(int component, int newSize);
+        void removeNeighbour(int v, int neighbour);
+};
+
+
 /* bounded arboricity graph (represented as a collection of forests,
    where every edge belongs to one particular forest) */
 class BoundedArbGraph {
@@ -43,19 +93,45 @@ class BoundedArbGraph {
         const int V;
         const int alpha; // arboricity upper bound
         vector<Forest> forests;
+        vector<ComponentIndex> components; // one per forest, unless disabled
+        FenwickTree<int> forestEdgeCounts; // edge count of every forest
+        int edgeCount;                     // total over all forests
+        unordered_map<unsigned long long, int> edgeOwners; // packed edge -> forest
     
     public:
-        BoundedArbGraph(int V, int alpha) :
+        BoundedArbGraph(int V, int alpha, bool indexComponents = false) :
             V(V),
             alpha(alpha),
-            forests(alpha, Forest(V)) {}
+            forests(alpha, Forest(V)),
+            forestEdgeCounts(alpha),
+            edgeCount(0) {
+            // no ComponentIndex is built at all unless requested
+            if (indexComponents) {
+                components.reserve(alpha);
+                for (int f = 0; f < alpha; f++) components.emplace_back(V);
+            }
+        }
         
         bool isAdjacent(int va, int vb);
         bool insertEdge(int forestIndex, int va, int vb); // returns true iff insertion was successful
         void deleteEdge(int va, int vb);
+        
+        /* Deletes many edges at once (all have to be present), grouped
+           by forest; see Forest::deleteEdges. */
+        void deleteEdges(const vector< pair<int,int> > &removed);
+        
         void printDescription(ostream &outputStream); // description in DOT format
         pair<int,int> getEdge(int index); // edge numbering starts from 0
-        int getEdgeCount();
+        vector< pair<int,int> > getAllEdges(); // forest by forest
+        int getEdgeCount() { return edgeCount; }
+        
+        /* Cross-component vertex pairs of a forest, i.e. candidates for
+           insertion into that forest. Requires indexComponents. */
+        long long getCrossPairCount(int forestIndex);
+        pair<int,int> getCrossPair(int forestIndex, long long rank);
+    
+    private:
+        unsigned long long packEdge(int va, int vb); // order of endpoints is irrelevant
 };
 
 
@@ -5,7 +5,7 @@ using std::max;
 
 void IntervalTreeNode::printNode(ostream &outputStream) {
     outputStream << "[" << getLow() << "," << getHigh() << "],"
-    << "h=" << height << ",hs=" << highest;
+    << "h=" << height << ",hs=" << highest << ",c=" << count;
 }
 
 /* Empties the tree and frees allocated memory. */
@@ -48,11 +48,6 @@ bool IntervalTree::contains(int low, int high) const {
     return search(root, target) != nullptr;
 }
 
-/* Do the two intervals have a nonempty overlap? */
-bool IntervalTree::areIntervalsClashing(auto &intA, auto &intB) const {
-    return intA.first <= intB.second && intB.first <= intA.second;
-}
-
 using IntervalList = vector<pair<int,int>>;
 
 /* Returns all intervals stored in the tree that overlap
@@ -60,31 +55,34 @@ using IntervalList = vector<pair<int,int>>;
 IntervalList IntervalTree::getClashes(int low, int high) const {
     assert (low <= high);
     IntervalList result;
-    pair<int,int> query(low, high);
-    collectClashes(root, query, result);
+    forEachClash(low, high, [&result](int clashLow, int clashHigh) {
+        result.emplace_back(clashLow, clashHigh);
+    });
     return result; // no copy here (move semantics)
 }
 
 /* Returns the number of intervals stored in the tree
    that overlap with the query interval. */
 int IntervalTree::countClashes(int low, int high) const {
-    IntervalList clashes = getClashes(low, high);
-    return clashes.size();
-}
-
-void IntervalTree::collectClashes(auto *node, pair<int,int> &query, IntervalList &result) const {
-    if (node == nullptr) return;
-    // Skip further search if no intervals in the subtree may clash.
-    if (node->highest < query.first) return;
-    
-    collectClashes(node->left, query, result);
-    if (areIntervalsClashing(node->range, query)) {
-        result.push_back(node->range);
-    }
-    // Another possible skip, using the BST property.
-    if (node->range.first <= query.second) {
-        collectClashes(node->right, query, result);
+    assert (low <= high);
+    /* Intervals ending before "low" also start before "high", hence
+       the clashing ones are those starting no later than "high",
+       apart from the ones that end too early. */
+    return countStartingUpTo(high) - highs.countLess(low);
+}
+
+/* number of intervals with low <= bound (a single root-leaf walk) */
+int IntervalTree::countStartingUpTo(int bound) const {
+    int result = 0;
+    const IntervalTreeNode *node = root;
+    while (node != nullptr) {
+        if (node->getLow() <= bound) {
+            result += getCount(node->left) + 1;
+            node = node->right;
+        }
+        else node = node->left;
     }
+    return result;
 }
 
 int IntervalTree::getHighest(const auto *node) const {
@@ -92,6 +90,11 @@ int IntervalTree::getHighest(const auto *node) const {
     else return node->highest;
 }
 
+unsigned int IntervalTree::getCount(const auto *node) const {
+    if (node == nullptr) return 0;
+    else return node->count;
+}
+
 int IntervalTree::getHeight(const auto *node) const {
     if (node == nullptr) return 0;
     else return node->height;
@@ -103,6 +106,7 @@ void IntervalTree::updateAuxValues(auto *node) {
     node->height = 1 + max(getHeight(node->left), getHeight(node->right));
     node->highest = max(node->getHigh(),
                     max(getHighest(node->left), getHighest(node->right)));
+    node->count = 1 + getCount(node->left) + getCount(node->right);
 }
 
 /* AVL right-rotation procedure, called when the node is unbalanced.
@@ -155,6 +159,7 @@ void IntervalTree::insert(int low, int high) {
     assert (low <= high);
     pair<int,int> addend(low, high);
     root = insertHelper(root, addend);
+    highs.insert(high);
     nodeCount++;
 }
 
@@ -173,7 +178,9 @@ IntervalTreeNode* IntervalTree::insertHelper(auto *node, pair<int,int> &addend)
 void IntervalTree::remove(int low, int high) {
     assert (low <= high);
     pair<int,int> target(low, high);
+    const unsigned int previousCount = nodeCount;
     root = removeHelper(root, target);
+    if (nodeCount < previousCount) highs.remove(high);
 }
 
 IntervalTreeNode* IntervalTree::removeHelper(auto *node, pair<int,int> &target) {
@@ -4,6 +4,8 @@
 #include <iostream>
 #include <vector>
 #include <utility>
+#include "avl-tree.h"
+#include "avl-tree.cpp"
 using std::ostream;
 using std::vector;
 using std::pair;
@@ -12,25 +14,31 @@ using std::pair;
 struct IntervalTreeNode {
     pair<int,int> range;            // describes the [low, high] interval
     int highest;                    // maximum "high" value in the subtree
+    unsigned int count;             // total number of nodes in the subtree
     unsigned int height;            // node count on the longest root-leaf path
     IntervalTreeNode *left, *right; // pointers to subtrees
     
     IntervalTreeNode(pair<int,int> &range) : range(range), highest(getHigh()),
-        height(1), left(nullptr), right(nullptr) {};
+        count(1), height(1), left(nullptr), right(nullptr) {};
     
-    int getLow() { return range.first; }
-    int getHigh() { return range.second; }
+    int getLow() const { return range.first; }
+    int getHigh() const { return range.second; }
     
     // Succinct text representation of the node.
     void printNode(ostream &outputStream);
 };
 
 /* Interval tree structure, implemented as an augmented AVL tree,
-   as described in "Introduction to Algorithms" by Cormen et al. */
+   as described in "Introduction to Algorithms" by Cormen et al.
+   Besides the largest "high" value, every node keeps the size of its
+   subtree. The "high" values are also kept in a separate order-statistic
+   tree, so countClashes takes two O(log n) rank queries, regardless
+   of the number of clashes. */
 class IntervalTree {
     private:
         IntervalTreeNode *root;
         unsigned int nodeCount;
+        AVLTree<int> highs; // "high" values of all intervals, see countClashes
     
     public:
         IntervalTree() : root(nullptr), nodeCount(0) {}
@@ -55,6 +63,14 @@ class IntervalTree {
            that overlap with the query interval. */
         int countClashes(int low, int high) const;
         
+        /* Calls visit(low, high) for every interval stored in the tree that
+           overlaps with the query interval, in the order of getClashes.
+           Nothing is allocated; the tree must not be modified meanwhile. */
+        template <typename F>
+        void forEachClash(int low, int high, F &&visit) const {
+            visitClashes(root, low, high, visit);
+        }
+        
         /* Inserts a new [low, high] interval. The tree can store
            multiple intervals that have the same endpoints. */
         void insert(int low, int high);
@@ -72,10 +88,12 @@ class IntervalTree {
         IntervalTreeNode* getMaxNode(auto *node) const;
         IntervalTreeNode* search(auto *node, pair<int,int> &target) const;
         
-        bool areIntervalsClashing(auto &intA, auto &intB) const;
-        void collectClashes(auto *node, pair<int,int> &query, IntervalList &result) const;
+        template <typename F>
+        void visitClashes(const IntervalTreeNode *node, int low, int high, F &visit) const;
         
         int getHighest(const auto *node) const;
+        unsigned int getCount(const auto *node) const;
+        int countStartingUpTo(int bound) const;
         int getHeight(const auto *node) const;
         void updateAuxValues(auto *node);
         IntervalTreeNode* rotateRight(auto *node);
@@ -89,5 +107,20 @@ class IntervalTree {
         void printTreeHelper(auto *node, ostream &outputStream);
 };
 
+template <typename F>
+void IntervalTree::visitClashes(const IntervalTreeNode *node, int low, int high,
+                                F &visit) const {
+    if (node == nullptr) return;
+    // Skip further search if no intervals in the subtree may clash.
+    if (node->highest < low) return;
+    
+    visitClashes(node->left, low, high, visit);
+    if (node->range.first <= high && low <= node->range.second) {
+        visit(node->range.first, node->range.second);
+    }
+    // Another possible skip, using the BST property.
+    if (node->range.first <= high) visitClashes(node->right, low, high, visit);
+}
+
 #endif
 
@@ -103,3 +103,46 @@ bool LinkCutTrees::connected(int u, int v) {
     return nodes[u].parent != nullptr;
 }
 
+
+/* Discards the current trees and represents the forest given by
+   its edge list instead, in O(V + edges). */
+void LinkCutTrees::rebuild(const vector< pair<int,int> > &edges) {
+    const int N = nodes.size();
+    vector<int> firstEdge(N + 1, 0); // adjacency in compressed form
+    for (auto &edge : edges) {
+        firstEdge[edge.first + 1]++;
+        firstEdge[edge.second + 1]++;
+    }
+    for (int v = 0; v < N; v++) firstEdge[v+1] += firstEdge[v];
+    vector<int> neighbours(firstEdge[N]);
+    vector<int> fill(firstEdge.begin(), firstEdge.end() - 1);
+    for (auto &edge : edges) {
+        neighbours[fill[edge.first]++] = edge.second;
+        neighbours[fill[edge.second]++] = edge.first;
+    }
+    
+    for (LinkCutTreeNode &node : nodes) {
+        node.left = node.right = node.parent = nullptr;
+        node.reversed = false;
+    }
+    
+    // BFS from every unvisited vertex; parent pointers become path-parent pointers
+    vector<bool> visited(N, false);
+    vector<int> queue;
+    queue.reserve(N);
+    for (int root = 0; root < N; root++) {
+        if (visited[root]) continue;
+        visited[root] = true;
+        queue.assign(1, root);
+        for (int head = 0; head < (int)queue.size(); head++) {
+            int v = queue[head];
+            for (int e = firstEdge[v]; e < firstEdge[v+1]; e++) {
+                int u = neighbours[e];
+                if (visited[u]) continue;
+                visited[u] = true;
+                nodes[u].parent = &nodes[v];
+                queue.push_back(u);
+            }
+        }
+    }
+}
@@ -2,7 +2,9 @@
 #define LINK_CUT_TREE_H
 
 #include <vector>
+#include <utility>
 using std::vector;
+using std::pair;
 
 /* Link/cut trees structure implementation. Used mainly during graph generation
    for testing connectivity. Adapted from Bassel Bakr (github.com/Bassel-Bakr) */
@@ -31,6 +33,11 @@ class LinkCutTrees {
         void link(int u, int v);
         void cut(int u, int v);
         bool connected(int u, int v);
+        
+        /* Discards the current trees and represents the forest given by
+           its edge list instead, in O(V + edges): every tree is rooted and
+           each node starts as a path of its own, hanging from its parent. */
+        void rebuild(const vector< pair<int,int> > &edges);
     
     private:
         void rotate(LinkCutTreeNode *child);
@@ -1,4 +1,5 @@
 #include "logic.h"
+#include "parallel.h"
 #include <string>
 #include <set>
 #include <cmath>
@@ -8,8 +9,10 @@ using std::to_string;
 using std::min;
 using std::max;
 using std::set;
-using std::multiset;
-using std::set_difference;
+using std::remove_if;
+using std::make_heap;
+using std::push_heap;
+using std::pop_heap;
 
 
 string Literal::printLiteral() {
@@ -95,6 +98,7 @@ Verdict Formula::simplifyOnce(Valuation &val) {
     
     // new formula built as a separate object
     vector<Clause> nextFormula;
+    const bool trackScores = !branchScores.score.empty();
     
     for (Clause &clause : formula) {
         Clause nextClause;
@@ -114,10 +118,19 @@ Verdict Formula::simplifyOnce(Valuation &val) {
             }
         }
         
-        if (!clauseSatisfied) {
-            if (nextClause.empty()) return UNSATISFIABLE;
-            else nextFormula.push_back(nextClause);
+        if (!clauseSatisfied && nextClause.empty()) return UNSATISFIABLE;
+        
+        if (trackScores && (clauseSatisfied || nextClause.size() < clause.size())) {
+            // withdraw the old contributions, then add the shortened clause back
+            double oldWeight = getLiteralWeight(clause.size());
+            for (Literal &lit : clause) adjustScore(lit.index, -oldWeight, -1);
+            if (!clauseSatisfied) {
+                double newWeight = getLiteralWeight(nextClause.size());
+                for (Literal &lit : nextClause) adjustScore(lit.index, newWeight, +1);
+            }
         }
+        
+        if (!clauseSatisfied) nextFormula.push_back(nextClause);
     }
     
     if (nextFormula.empty()) return SATISFIABLE;
@@ -146,32 +159,115 @@ Verdict Formula::simplify(Valuation &val) {
     }
 }
 
-/* heuristic to choose a branching literal (Jeroslow-Wang rule) */
+/* heuristic to choose a branching literal (Jeroslow-Wang rule by default) */
 VarIndex Formula::getBestBranch() {
-    map<VarIndex, double> scores;
+    vector<ScoreEntry> &heap = branchScores.heap;
+    // Outdated entries pile up; drop them all once they dominate the heap.
+    if (heap.size() > 4 * branchScores.score.size()) rebuildScoreHeap();
     
-    for (Clause &clause : formula) {
-        unsigned int length = clause.size();
-        for (Literal &lit : clause) {
-            scores[lit.index] += 1 / pow(2, length);
+    auto order = [this](const ScoreEntry &a, const ScoreEntry &b) {
+        return ranksBelow(a, b);
+    };
+    
+    // Discard outdated entries and variables that left the formula.
+    while (true) {
+        const ScoreEntry &top = heap.front();
+        if (top.stamp == branchScores.stamp[top.index] &&
+            branchScores.occurrences[top.index] > 0) return top.index;
+        pop_heap(heap.begin(), heap.end(), order);
+        heap.pop_back();
+    }
+}
+
+/* Is variable a preferred over b when both have the same score? */
+bool Formula::winsTieBreak(VarIndex a, VarIndex b) {
+    switch (config.tieBreak) {
+        case LOWEST_INDEX: return a < b;
+        case HIGHEST_INDEX: return a > b;
+        case RANDOM_ORDER: {
+            // seeded hash (splitmix64 finalizer) defines a random variable order
+            auto rank = [this](VarIndex x) {
+                unsigned long long z = x + 0x9E3779B97F4A7C15ULL * (config.seed + 1);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            };
+            return rank(a) < rank(b);
         }
     }
+    return false;
+}
+
+/* score contributed by a literal of a clause with the given length */
+double Formula::getLiteralWeight(unsigned int clauseLength) {
+    if (config.heuristic == JEROSLOW_WANG) return ldexp(1.0, -(int)clauseLength);
+    else return 1;
+}
+
+/* computes scores of all variables from scratch */
+void Formula::initBranchScores() {
+    VarIndex maxIndex = 0;
+    for (Clause &clause : formula) {
+        for (Literal &lit : clause) maxIndex = max(maxIndex, lit.index);
+    }
     
-    VarIndex bestBranch = 0;
-    for (auto const &s : scores) {
-        VarIndex currentBranch = s.first;
-        if (scores[currentBranch] > scores[bestBranch]) {
-            bestBranch = currentBranch;
+    branchScores.score.assign(maxIndex + 1, 0);
+    branchScores.occurrences.assign(maxIndex + 1, 0);
+    branchScores.stamp.assign(maxIndex + 1, 0);
+    
+    for (Clause &clause : formula) {
+        double weight = getLiteralWeight(clause.size());
+        for (Literal &lit : clause) {
+            branchScores.score[lit.index] += weight;
+            branchScores.occurrences[lit.index]++;
         }
     }
+    rebuildScoreHeap();
+}
+
+/* replaces the heap with a fresh one, holding current entries only */
+void Formula::rebuildScoreHeap() {
+    vector<ScoreEntry> &heap = branchScores.heap;
+    heap.clear();
+    for (VarIndex index = 0; index < branchScores.score.size(); index++) {
+        if (branchScores.occurrences[index] == 0) continue;
+        heap.push_back(ScoreEntry { branchScores.score[index], index,
+                                    branchScores.stamp[index] });
+    }
+    make_heap(heap.begin(), heap.end(),
+              [this](const ScoreEntry &a, const ScoreEntry &b) { return ranksBelow(a, b); });
+}
+
+/* shifts the score and occurrence count of a variable, pushing
+   a fresh heap entry (older ones become outdated) */
+void Formula::adjustScore(VarIndex index, double scoreDelta, int occurrencesDelta) {
+    branchScores.score[index] += scoreDelta;
+    branchScores.occurrences[index] += occurrencesDelta;
+    branchScores.stamp[index]++;
+    if (branchScores.occurrences[index] == 0) return; // variable left the formula
     
-    return bestBranch;
+    vector<ScoreEntry> &heap = branchScores.heap;
+    heap.push_back(ScoreEntry { branchScores.score[index], index, branchScores.stamp[index] });
+    push_heap(heap.begin(), heap.end(),
+              [this](const ScoreEntry &a, const ScoreEntry &b) { return ranksBelow(a, b); });
+}
+
+/* heap order: does entry a rank below entry b? */
+bool Formula::ranksBelow(const ScoreEntry &a, const ScoreEntry &b) {
+    if (a.score != b.score) return a.score < b.score;
+    return winsTieBreak(b.index, a.index);
+}
+
+bool Formula::isCancelled() {
+    return cancelFlag != nullptr && cancelFlag->load(std::memory_order_relaxed);
 }
 
 /* A helper function that branches recursively until all possible valuations
    are tested. If vrd is SATISFIABLE, the satisfying valuation is stored
    and propagated up the search tree in the satisfVal parameter. */
 void Formula::solveDPHelper(Valuation &currentVal, Verdict &vrd, Valuation &satisfVal) {
+    if (isCancelled()) return;
+    
     Verdict infer = simplify(currentVal);
     if (infer == UNSATISFIABLE) return;
     else if (infer == SATISFIABLE) {
@@ -184,17 +280,20 @@ void Formula::solveDPHelper(Valuation &currentVal, Verdict &vrd, Valuation &sati
     // find best variable to branch further
     VarIndex branch = getBestBranch();
     vector<Clause> formulaCopy = formula;
+    BranchScores scoresCopy = branchScores;
+    Valuation valCopy = currentVal; // failed branches clear the valuation
     
-    // TRUE branch
-    currentVal[branch] = true;
+    // first branch
+    currentVal[branch] = config.trueBranchFirst;
     solveDPHelper(currentVal, vrd, satisfVal);
     if (vrd == SATISFIABLE) return; // prune search tree on success
     
     formula = formulaCopy;
-    currentVal.erase(branch);
+    branchScores = scoresCopy;
+    currentVal = valCopy;
     
-    // FALSE branch
-    currentVal[branch] = false;
+    // second branch
+    currentVal[branch] = !config.trueBranchFirst;
     solveDPHelper(currentVal, vrd, satisfVal);
 }
 
@@ -206,13 +305,68 @@ Verdict Formula::solveDP(Valuation &val) {
     Verdict verdict = UNSATISFIABLE;
     Valuation satisfVal;
     
+    initBranchScores();
     solveDPHelper(val, verdict, satisfVal);
     formula.clear();
+    branchScores = BranchScores();
     
-    if (verdict == UNSATISFIABLE) val.clear();
+    if (verdict == UNSATISFIABLE && isCancelled()) verdict = NO_VERDICT;
+    if (verdict == SATISFIABLE) val = satisfVal;
+    else val.clear();
     return verdict;
 }
 
+/* Runs one Davis-Putnam search per configuration, each in a separate
+   thread on its own copy of the formula. The first verdict reached
+   is returned (with its valuation) and the remaining searches are
+   cancelled. The formula gets erased, as in solveDP. */
+Verdict Formula::solvePortfolio(Valuation &val, const vector<SolverConfig> &configs) {
+    atomic<bool> finished(false); // set by the first search to reach a verdict
+    Verdict verdict = NO_VERDICT;
+    Valuation winnerVal;
+    
+    ThreadPool pool(configs.size());
+    pool.parallelFor(configs.size(), [&](int c) {
+        Formula candidate = *this;
+        candidate.config = configs[c];
+        candidate.cancelFlag = &finished;
+        Valuation candidateVal = val;
+        
+        Verdict candidateVerdict = candidate.solveDP(candidateVal);
+        if (candidateVerdict == NO_VERDICT) return;
+        
+        bool expected = false;
+        if (finished.compare_exchange_strong(expected, true)) {
+            verdict = candidateVerdict; // only the first finisher writes
+            winnerVal = candidateVal;
+        }
+    });
+    
+    formula.clear();
+    val = winnerVal;
+    return verdict;
+}
+
+/* Returns "count" diverse solver configurations, starting with the default one. */
+vector<SolverConfig> getPortfolioConfigs(int count) {
+    vector<SolverConfig> configs;
+    for (int c = 0; c < count; c++) {
+        switch (c) {
+            case 0: configs.push_back(DEFAULT_SOLVER_CONFIG); break;
+            case 1: configs.push_back({ JEROSLOW_WANG, HIGHEST_INDEX, false, 0 }); break;
+            case 2: configs.push_back({ MOST_OCCURRENCES, LOWEST_INDEX, true, 0 }); break;
+            case 3: configs.push_back({ MOST_OCCURRENCES, HIGHEST_INDEX, false, 0 }); break;
+            default: { // randomized variable orders
+                BranchingHeuristic heuristic = (c % 2) ? MOST_OCCURRENCES : JEROSLOW_WANG;
+                bool trueBranchFirst = (c / 2) % 2 == 0;
+                configs.push_back({ heuristic, RANDOM_ORDER, trueBranchFirst,
+                                    static_cast<unsigned int>(c) });
+            }
+        }
+    }
+    return configs;
+}
+
 /* Pretty-printer of a Formula object. */
 void Formula::printFormula(ostream &outputStream) {
     for (Clause &clause : formula) {
@@ -228,85 +382,236 @@ void Formula::printFormula(ostream &outputStream) {
 /* Constructs a CNF formula satisfiable iff there exists a solution
    of the IntervalProblemInstance representing a graph orientation
    where each vertex has an outdegree of at most outdegBound. */
-Formula convertToSAT(IntervalProblemInstance &ipi, int outdegBound) {
+Formula convertToSAT(IntervalProblemInstance &ipi, int outdegBound,
+                     CardinalityEncoding encoding) {
     Formula phi; // reduction result in CNF form
-    vector<vector<Interval>::iterator> currentPath; // picked intervals
-    pair<int,int> currentTimespan(0, ipi.timeframe); // common timespan of picked intervals
+    vector<vector<int>> buckets = bucketIntervalsByVertex(ipi);
+    VarIndex nextFreeVar = ipi.intervals.size() + 1; // first auxiliary variable
     
-    convertToSATHelper(currentPath, currentTimespan, ipi.intervals.begin(),
-                       ipi.intervals, outdegBound+1, phi);
+    for (int v = 0; v < ipi.V; v++) {
+        if (encoding == BINOMIAL) {
+            addVertexClauses(v, buckets[v], ipi, outdegBound, phi);
+        }
+        else addVertexCardinality(v, buckets[v], ipi, outdegBound,
+                                  encoding, nextFreeVar, phi);
+    }
     
     return phi;
 }
 
-/* recursive check of all possible clauses; prunes search tree for efficiency */
-void convertToSATHelper(auto &currentPath, pair<int,int> currentTimespan,
-                        auto startIterator, vector<Interval> &intervals,
-                        int stepsLeft, Formula &builtFormula) {
+/* Solves the same problem as convertToSAT followed by solveDP, but splits
+   the instance into independent components first (see splitIntoComponents).
+   Every component is reduced and solved on its own, in parallel. The merged
+   valuation covers the interval variables only (numbered as in convertToSAT);
+   it is empty unless every component is satisfiable. */
+Verdict solveByComponents(IntervalProblemInstance &ipi, int outdegBound, Valuation &val,
+                          CardinalityEncoding encoding, int threads) {
+    vector<vector<int>> origins, vertexOrigins;
+    vector<IntervalProblemInstance> components = splitIntoComponents(ipi, origins,
+                                                                     vertexOrigins);
+    
+    vector<Valuation> componentVals(components.size());
+    atomic<bool> unsatisfiable(false); // a single failure decides the instance
+    
+    ThreadPool pool(threads);
+    pool.parallelFor(components.size(), [&](int c) {
+        if (unsatisfiable) return;
+        Formula phi = convertToSAT(components[c], outdegBound, encoding);
+        phi.setCancelFlag(&unsatisfiable);
+        if (phi.solveDP(componentVals[c]) == UNSATISFIABLE) unsatisfiable = true;
+    });
+    
+    val.clear();
+    if (unsatisfiable) return UNSATISFIABLE;
+    
+    // Translate local variable numbers back to the original instance.
+    for (int c = 0; c < components.size(); c++) {
+        for (auto const &entry : componentVals[c]) {
+            VarIndex local = entry.first;
+            if (local > origins[c].size()) continue; // auxiliary variable
+            val[origins[c][local-1] + 1] = entry.second;
+        }
+    }
+    return SATISFIABLE;
+}
+
+/* Sweeps the intervals incident to vertex v in order of their start times.
+   Whenever an interval begins, every choice of outdegBound intervals still
+   active at that moment yields a clause forbidding all of them (together
+   with the new one) to be assigned to v. Only overlapping intervals
+   are ever visited, so the work is proportional to the number of clauses. */
+void addVertexClauses(int v, vector<int> &bucket, IntervalProblemInstance &ipi,
+                      int outdegBound, Formula &builtFormula) {
+    vector<int> active; // intervals covering the current sweep position
+    Clause currentClause;
+    
+    for (int index : bucket) {
+        const unsigned int now = ipi.intervals[index].startTime;
+        
+        // Drop intervals that ended before the current one began.
+        active.erase(remove_if(active.begin(), active.end(), [&](int other) {
+            return ipi.intervals[other].endTime < now;
+        }), active.end());
+        
+        /* Pairwise overlapping intervals share a common timestamp, hence each
+           clause is produced exactly once - by its latest starting interval. */
+        currentClause.push_back(getAvoidingLiteral(index, v, ipi));
+        enumerateClauses(active, 0, outdegBound, currentClause, v, ipi, builtFormula);
+        currentClause.pop_back();
+        
+        active.push_back(index);
+    }
+}
+
+/* recursive enumeration of outdegBound-element subsets of active intervals */
+void enumerateClauses(vector<int> &active, int startIndex, int stepsLeft,
+                      Clause &currentClause, int v, IntervalProblemInstance &ipi,
+                      Formula &builtFormula) {
     if (stepsLeft == 0) { // new clause found
-        Clause newClause = buildClause(currentPath, intervals.begin());
-        builtFormula.addClause(newClause);
+        builtFormula.addClause(currentClause);
         return;
     }
     
-    for (auto iter = startIterator; iter != intervals.end(); ++iter) {
-        // check for timespan intersection
-        int newStartTime = max(currentTimespan.first, (int)iter->startTime);
-        int newEndTime = min(currentTimespan.second, (int)iter->endTime);
-        if (newStartTime > newEndTime) continue;
+    // prune if there are not enough intervals left to complete the clause
+    for (int p = startIndex; p + stepsLeft <= active.size(); p++) {
+        currentClause.push_back(getAvoidingLiteral(active[p], v, ipi));
+        enumerateClauses(active, p + 1, stepsLeft - 1, currentClause, v, ipi, builtFormula);
+        currentClause.pop_back();
+    }
+}
+
+/* Sweeps the intervals incident to vertex v and bounds the number of intervals
+   assigned to v within every maximal set of simultaneously active intervals.
+   Each such set is encoded separately with the requested counter encoding. */
+void addVertexCardinality(int v, vector<int> &bucket, IntervalProblemInstance &ipi,
+                          int outdegBound, CardinalityEncoding encoding,
+                          VarIndex &nextFreeVar, Formula &builtFormula) {
+    vector<int> active; // intervals covering the current sweep position
+    vector<Literal> assignedLits; // "interval is assigned to v" literals
+    
+    for (int p = 0; p < bucket.size(); p++) {
+        const unsigned int now = ipi.intervals[bucket[p]].startTime;
+        active.erase(remove_if(active.begin(), active.end(), [&](int other) {
+            return ipi.intervals[other].endTime < now;
+        }), active.end());
+        active.push_back(bucket[p]);
         
-        // check for common node
-        bool commonNodeExists;
-        if (currentPath.empty()) commonNodeExists = true;
-        else if (currentPath.size() == 1) {
-            commonNodeExists = (currentPath[0]->nodes.first == iter->nodes.first ||
-                                currentPath[0]->nodes.first == iter->nodes.second ||
-                                currentPath[0]->nodes.second == iter->nodes.first ||
-                                currentPath[0]->nodes.second == iter->nodes.second);
-        } else {
-            // shared node is uniquely determined
-            int commonNode = getCommonNode(currentPath);
-            commonNodeExists = (iter->nodes.first == commonNode ||
-                                iter->nodes.second == commonNode);
+        /* The active set is maximal iff one of its intervals ends
+           before the next interval (if any) begins. */
+        unsigned int earliestEnd = ipi.intervals[active[0]].endTime;
+        for (int index : active) {
+            earliestEnd = min(earliestEnd, ipi.intervals[index].endTime);
         }
+        bool isMaximal = (p+1 == bucket.size() ||
+                          ipi.intervals[bucket[p+1]].startTime > earliestEnd);
+        if (!isMaximal || active.size() <= outdegBound) continue;
         
-        if (!commonNodeExists) continue;
+        assignedLits.clear();
+        for (int index : active) {
+            assignedLits.push_back(negateLiteral(getAvoidingLiteral(index, v, ipi)));
+        }
         
-        currentPath.push_back(iter);
-        convertToSATHelper(currentPath, pair<int,int>(newStartTime, newEndTime),
-                           iter + 1, intervals, stepsLeft - 1, builtFormula);
-        currentPath.pop_back();
+        if (encoding == SEQUENTIAL_COUNTER) {
+            encodeSequentialCounter(assignedLits, outdegBound, nextFreeVar, builtFormula);
+        }
+        else encodeTotalizer(assignedLits, outdegBound, nextFreeVar, builtFormula);
     }
 }
 
-/* returns a node shared by all visited intervals */
-int getCommonNode(vector<vector<Interval>::iterator> path) {
-    assert (!path.empty());
-    multiset<int> occurrences;
-    
-    for (auto intv : path) {
-        occurrences.insert(intv->nodes.first);
-        occurrences.insert(intv->nodes.second);
+/* at most "bound" of the literals are true (sequential counter encoding) */
+void encodeSequentialCounter(vector<Literal> &lits, int bound,
+                             VarIndex &nextFreeVar, Formula &builtFormula) {
+    const int n = lits.size();
+    if (n <= bound) return; // constraint holds trivially
+    if (bound == 0) { // every literal has to be false
+        for (Literal &lit : lits) {
+            Clause unit = { negateLiteral(lit) };
+            builtFormula.addClause(unit);
+        }
+        return;
     }
     
-    for (int x : occurrences) {
-        if (occurrences.count(x) == path.size()) return x;
-    }
+    /* Register variable reg(i, j) holds iff at least j+1 of the first
+       i+1 literals are true (0 <= i < n-1, 0 <= j < bound). */
+    const VarIndex firstReg = nextFreeVar;
+    nextFreeVar += (n-1) * bound;
+    auto reg = [&](int i, int j, Polarity plr) {
+        return Literal { plr, firstReg + (VarIndex)(i * bound + j) };
+    };
+    
+    auto emit = [&](Clause clause) { builtFormula.addClause(clause); };
+    
+    emit({ negateLiteral(lits[0]), reg(0, 0, POSITIVE) });
+    for (int j = 1; j < bound; j++) emit({ reg(0, j, NEGATIVE) });
     
-    assert (false); // a common node should have existed
+    for (int i = 1; i < n-1; i++) {
+        emit({ negateLiteral(lits[i]), reg(i, 0, POSITIVE) });
+        emit({ reg(i-1, 0, NEGATIVE), reg(i, 0, POSITIVE) });
+        for (int j = 1; j < bound; j++) {
+            emit({ negateLiteral(lits[i]), reg(i-1, j-1, NEGATIVE), reg(i, j, POSITIVE) });
+            emit({ reg(i-1, j, NEGATIVE), reg(i, j, POSITIVE) });
+        }
+        // counter overflow
+        emit({ negateLiteral(lits[i]), reg(i-1, bound-1, NEGATIVE) });
+    }
+    emit({ negateLiteral(lits[n-1]), reg(n-2, bound-1, NEGATIVE) });
 }
 
-/* describes visited intervals with a clause */
-Clause buildClause(vector<vector<Interval>::iterator> path, auto startIterator) {
-    int commonNode = getCommonNode(path);
-    Clause newClause;
+/* at most "bound" of the literals are true (totalizer encoding) */
+void encodeTotalizer(vector<Literal> &lits, int bound,
+                     VarIndex &nextFreeVar, Formula &builtFormula) {
+    vector<Literal> outputs = buildTotalizerNode(lits, 0, lits.size(), bound,
+                                                 nextFreeVar, builtFormula);
+    if (outputs.size() > bound) { // forbid exceeding the bound
+        Clause overflow = { negateLiteral(outputs[bound]) };
+        builtFormula.addClause(overflow);
+    }
+}
+
+/* Builds the totalizer subtree over lits[from, to) and returns its unary
+   outputs: the j-th output (from 0) is forced whenever more than j inputs hold.
+   Outputs are truncated at bound+1, as larger counts are never inspected. */
+vector<Literal> buildTotalizerNode(vector<Literal> &lits, int from, int to, int bound,
+                                   VarIndex &nextFreeVar, Formula &builtFormula) {
+    if (to - from == 1) return vector<Literal> { lits[from] };
     
-    for (auto intv : path) {
-        unsigned int intervalNum = intv - startIterator + 1;
-        Polarity plr = (intv->nodes.first == commonNode) ?
-            POSITIVE : NEGATIVE;
-        newClause.push_back(Literal { plr, intervalNum });
+    const int mid = from + (to - from) / 2;
+    vector<Literal> left = buildTotalizerNode(lits, from, mid, bound,
+                                              nextFreeVar, builtFormula);
+    vector<Literal> right = buildTotalizerNode(lits, mid, to, bound,
+                                               nextFreeVar, builtFormula);
+    
+    const int outputCount = min<int>(left.size() + right.size(), bound + 1);
+    vector<Literal> outputs;
+    for (int j = 0; j < outputCount; j++) {
+        outputs.push_back(Literal { POSITIVE, nextFreeVar++ });
     }
     
-    return newClause;
+    /* a >= i and b >= j implies output >= i+j
+       (index 0 stands for the trivially true "at least zero") */
+    for (int i = 0; i <= left.size(); i++) {
+        for (int j = 0; j <= right.size(); j++) {
+            if (i + j == 0 || i + j > outputCount) continue;
+            Clause clause;
+            if (i > 0) clause.push_back(negateLiteral(left[i-1]));
+            if (j > 0) clause.push_back(negateLiteral(right[j-1]));
+            clause.push_back(outputs[i+j-1]);
+            builtFormula.addClause(clause);
+        }
+    }
+    return outputs;
+}
+
+/* returns the literal with the opposite polarity */
+Literal negateLiteral(Literal lit) {
+    Polarity plr = (lit.polarity == POSITIVE) ? NEGATIVE : POSITIVE;
+    return Literal { plr, lit.index };
+}
+
+/* literal stating that the interval (numbered from 0) is not assigned to v */
+Literal getAvoidingLiteral(int intervalIndex, int v, IntervalProblemInstance &ipi) {
+    VarIndex intervalNum = intervalIndex + 1; // variable ordering starts at 1
+    Polarity plr = (ipi.intervals[intervalIndex].nodes.first == v) ?
+        POSITIVE : NEGATIVE;
+    return Literal { plr, intervalNum };
 }
@@ -4,11 +4,13 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <atomic>
 #include "converter.h"
 using std::ostream;
 using std::vector;
 using std::string;
 using std::map;
+using std::atomic;
 
 
 using VarIndex = unsigned int;
@@ -31,10 +33,54 @@ void printValuation(Valuation &val, ostream &outputStream);
 // satisfiability verdict
 enum Verdict { SATISFIABLE, UNSATISFIABLE, NO_VERDICT };
 
+// variable scoring rules used when choosing a branching variable
+enum BranchingHeuristic {
+    JEROSLOW_WANG,      // literal in a clause of length L scores 2^(-L)
+    MOST_OCCURRENCES    // every literal occurrence scores 1
+};
+
+// resolution of equal branching scores
+enum TieBreak { LOWEST_INDEX, HIGHEST_INDEX, RANDOM_ORDER };
+
+/* Configuration of the Davis-Putnam search. The seed determines
+   the variable order used by the RANDOM_ORDER tie-break. */
+struct SolverConfig {
+    BranchingHeuristic heuristic;
+    TieBreak tieBreak;
+    bool trueBranchFirst;   // which value of the branching variable is tried first
+    unsigned int seed;
+};
+
+const SolverConfig DEFAULT_SOLVER_CONFIG = { JEROSLOW_WANG, LOWEST_INDEX, true, 0 };
+
+/* Returns "count" diverse solver configurations, starting with the default one. */
+vector<SolverConfig> getPortfolioConfigs(int count);
+
+struct ScoreEntry {
+    double score;
+    VarIndex index;
+    unsigned int stamp; // entry is outdated unless it matches the variable's stamp
+};
+
+/* Branching scores kept up to date while the formula gets simplified,
+   so that the best branch is found without rescanning the formula. */
+struct BranchScores {
+    vector<double> score;             // indexed by VarIndex
+    vector<unsigned int> occurrences; // literal occurrences in the formula
+    vector<unsigned int> stamp;       // version of the newest heap entry
+    vector<ScoreEntry> heap;          // max-heap with lazily removed entries
+};
+
 // Representation of a formula in conjunctive normal form (CNF).
 class Formula {
     private:
         vector<Clause> formula;     // CNF formula is a collection of clauses
+        SolverConfig config;        // search parameters
+        BranchScores branchScores;  // maintained only during solveDP
+        
+        /* When set by another thread, the search gives up as soon
+           as possible and solveDP returns NO_VERDICT. */
+        const atomic<bool> *cancelFlag;
         
         /* first step of the Davis-Putnam algorithm: satisfies clauses
            with a single unassigned literal. The valuation is modified,
@@ -49,15 +95,41 @@ class Formula {
         /* single simplifying step - returns satisfiability verdict */
         Verdict simplifyOnce(Valuation &val);
         
-        /* heuristic to choose a branching literal (Jeroslow-Wang rule) */
+        /* heuristic to choose a branching literal (Jeroslow-Wang rule by default) */
         VarIndex getBestBranch();
         
+        /* Is variable a preferred over b when both have the same score? */
+        bool winsTieBreak(VarIndex a, VarIndex b);
+        
+        /* score contributed by a literal of a clause with the given length */
+        double getLiteralWeight(unsigned int clauseLength);
+        
+        /* computes scores of all variables from scratch */
+        void initBranchScores();
+        
+        /* replaces the heap with a fresh one, holding current entries only */
+        void rebuildScoreHeap();
+        
+        /* shifts the score and occurrence count of a variable, pushing
+           a fresh heap entry (older ones become outdated) */
+        void adjustScore(VarIndex index, double scoreDelta, int occurrencesDelta);
+        
+        /* heap order: does entry a rank below entry b? */
+        bool ranksBelow(const ScoreEntry &a, const ScoreEntry &b);
+        
+        bool isCancelled();
+        
         /* A helper function that branches recursively until all possible valuations
            are tested. If vrd is SATISFIABLE, the satisfying valuation is stored
            and propagated up the search tree in the satisfVal parameter. */
         void solveDPHelper(Valuation &currentVal, Verdict &vrd, Valuation &satisfVal);
     
     public:
+        Formula() : config(DEFAULT_SOLVER_CONFIG), cancelFlag(nullptr) {}
+        
+        void setConfig(SolverConfig cfg) { config = cfg; }
+        void setCancelFlag(const atomic<bool> *flag) { cancelFlag = flag; }
+        
         /* add a clause to the formula */
         void addClause(Clause &clause);
         
@@ -75,24 +147,77 @@ class Formula {
            gets erased after calling this function. */
         Verdict solveDP(Valuation &val);
         
+        /* Runs one Davis-Putnam search per configuration, each in a separate
+           thread on its own copy of the formula. The first verdict reached
+           is returned (with its valuation) and the remaining searches are
+           cancelled. The formula gets erased, as in solveDP. */
+        Verdict solvePortfolio(Valuation &val, const vector<SolverConfig> &configs);
+        
         /* pretty-printer */
         void printFormula(ostream &outputStream);
 };
 
+/* Available encodings of the "at most outdegBound intervals assigned
+   to a vertex at once" constraint:
+   BINOMIAL            - one clause per (outdegBound+1)-subset, no auxiliary variables
+   SEQUENTIAL_COUNTER  - Sinz's sequential counter, O(n * outdegBound) clauses
+   TOTALIZER           - Bailleux-Boufkhad totalizer truncated at outdegBound+1
+   Counter-based encodings introduce auxiliary variables numbered after
+   the interval variables; these also appear in satisfying valuations. */
+enum CardinalityEncoding { BINOMIAL, SEQUENTIAL_COUNTER, TOTALIZER };
+
 /* Constructs a CNF formula satisfiable iff there exists a solution
    of the IntervalProblemInstance representing a graph orientation
    where each vertex has an outdegree of at most outdegBound. */
-Formula convertToSAT(IntervalProblemInstance &ipi, int outdegBound);
+Formula convertToSAT(IntervalProblemInstance &ipi, int outdegBound,
+                     CardinalityEncoding encoding = BINOMIAL);
+
+/* Solves the same problem as convertToSAT followed by solveDP, but splits
+   the instance into independent components first (see splitIntoComponents).
+   Every component is reduced and solved on its own, in parallel. The merged
+   valuation covers the interval variables only (numbered as in convertToSAT);
+   it is empty unless every component is satisfiable. */
+Verdict solveByComponents(IntervalProblemInstance &ipi, int outdegBound, Valuation &val,
+                          CardinalityEncoding encoding = BINOMIAL, int threads = 1);
+
+/* Sweeps the intervals incident to vertex v in order of their start times.
+   Whenever an interval begins, every choice of outdegBound intervals still
+   active at that moment yields a clause forbidding all of them (together
+   with the new one) to be assigned to v. Only overlapping intervals
+   are ever visited, so the work is proportional to the number of clauses. */
+void addVertexClauses(int v, vector<int> &bucket, IntervalProblemInstance &ipi,
+                      int outdegBound, Formula &builtFormula);
+
+/* recursive enumeration of outdegBound-element subsets of active intervals */
+void enumerateClauses(vector<int> &active, int startIndex, int stepsLeft,
+                      Clause &currentClause, int v, IntervalProblemInstance &ipi,
+                      Formula &builtFormula);
+
+/* Sweeps the intervals incident to vertex v and bounds the number of intervals
+   assigned to v within every maximal set of simultaneously active intervals.
+   Each such set is encoded separately with the requested counter encoding. */
+void addVertexCardinality(int v, vector<int> &bucket, IntervalProblemInstance &ipi,
+                          int outdegBound, CardinalityEncoding encoding,
+                          VarIndex &nextFreeVar, Formula &builtFormula);
+
+/* at most "bound" of the literals are true (sequential counter encoding) */
+void encodeSequentialCounter(vector<Literal> &lits, int bound,
+                             VarIndex &nextFreeVar, Formula &builtFormula);
+
+/* at most "bound" of the literals are true (totalizer encoding) */
+void encodeTotalizer(vector<Literal> &lits, int bound,
+                     VarIndex &nextFreeVar, Formula &builtFormula);
 
-/* recursive check of all possible clauses; prunes search tree for efficiency */
-void convertToSATHelper(auto &currentPath, pair<int,int> currentTimespan,
-                        auto startIterator, vector<Interval> &intervals,
-                        int stepsLeft, Formula &builtFormula);
+/* Builds the totalizer subtree over lits[from, to) and returns its unary
+   outputs: the j-th output (from 0) is forced whenever more than j inputs hold.
+   Outputs are truncated at bound+1, as larger counts are never inspected. */
+vector<Literal> buildTotalizerNode(vector<Literal> &lits, int from, int to, int bound,
+                                   VarIndex &nextFreeVar, Formula &builtFormula);
 
-/* returns a node shared by all visited intervals */
-int getCommonNode(vector<vector<Interval>::iterator> path);
+/* returns the literal with the opposite polarity */
+Literal negateLiteral(Literal lit);
 
-/* describes visited intervals with a clause */
-Clause buildClause(vector<vector<Interval>::iterator> path, auto startIterator);
+/* literal stating that the interval (numbered from 0) is not assigned to v */
+Literal getAvoidingLiteral(int intervalIndex, int v, IntervalProblemInstance &ipi);
 
 #endif
@@ -8,6 +8,8 @@
 #include "solver.h"
 #include "logic.h"
 #include "strategies.h"
+#include "parallel.h"
+#include "benchmarks.h"
 using std::cout;
 using std::setprecision;
 using namespace std::chrono;
@@ -18,6 +20,12 @@ long long getMillisSinceEpoch();
 
 int main(int argc, char *argv[]) {
     
+    if (argc == 3 && string(argv[1]) == "--bench") {
+        if (runBenchmark(argv[2], cout)) return 0;
+        cout << "Unknown benchmark: " << argv[2] << "\n";
+        return 1;
+    }
+    
     const int NODES = 40;             // number of nodes in the graph
     const int ALPHA = 1;              // upper bound for arboricity
     const float EDGE_DENSITY = 0.8;   // expected fraction of possible edges
@@ -27,6 +35,7 @@ int main(int argc, char *argv[]) {
     
     const int ATTEMPTS_TARGET = 100;  // total number of generated instances
     const int STATS_CHECKPOINT = 10;  // print statistics after STATS_CHECKPOINT attempts
+    const double SEARCH_MILLIS = 0;   // local search budget per instance (0 = disabled)
     
     double avgKowalik = 0;
     double avgCustom = 0;
@@ -36,12 +45,18 @@ int main(int argc, char *argv[]) {
     cout << "arboricity <= " << ALPHA << ", ";
     cout << "instance length = " << INSTANCE_LEN << "\n\n";
     
+    // Instance i can be reproduced with gen.seedStream(masterSeed, i-1).
+    const unsigned long long masterSeed = getMillisSinceEpoch();
+    cout << "master seed = " << masterSeed << "\n\n";
+    
     UniformDistrGenerator gen(NODES, ALPHA, rd, EDGE_DENSITY, PURGE_PROB);
-    gen.setSeed(getMillisSinceEpoch());
+    vector<OrientationProblemInstance> instances = gen.generateInstances(
+        ATTEMPTS_TARGET, INSTANCE_LEN, masterSeed, getHardwareThreads());
     
+    SolverWorkspace workspace(getHardwareThreads()); // reused by all solveInstance calls
     for (int attempt = 1; attempt <= ATTEMPTS_TARGET; attempt++) {
         
-        OrientationProblemInstance opi = gen.generateInstance(INSTANCE_LEN);
+        OrientationProblemInstance &opi = instances[attempt-1];
         IntervalProblemInstance ipi = convertInstance(opi);
         
         // Launch strategy provided by Kowalik.
@@ -49,7 +64,11 @@ int main(int argc, char *argv[]) {
         
         // Launch user-defined strategy.
         int maxOutdegCustomStrategy = 0;
-        solveInstance(ipi, maxOutdegCustomStrategy);
+        solveInstance(ipi, maxOutdegCustomStrategy, workspace);
+        if (SEARCH_MILLIS > 0) {
+            LocalSearchBudget budget = {numeric_limits<long long>::max(), SEARCH_MILLIS};
+            improveSolution(ipi, maxOutdegCustomStrategy, workspace, budget);
+        }
         avgCustom += maxOutdegCustomStrategy;
         
         /* Example usage of SAT-solving capabilities:
@@ -58,6 +77,8 @@ int main(int argc, char *argv[]) {
          * Formula phi = convertToSAT(ipi, MAX_OUTDEG);
          * Valuation val; // meant to store satisfying valuation
          * Verdict verdict = phi.solveDP(val);
+         * // or, racing several configurations in parallel:
+         * // Verdict verdict = phi.solvePortfolio(val, getPortfolioConfigs(4));
          * if (verdict == SATISFIABLE) cout << "SAT\n";
          */
         
@@ -0,0 +1,77 @@
+
+#include "parallel.h"
+using std::unique_lock;
+using std::max;
+
+
+ThreadPool::ThreadPool(int threads) : task(nullptr), taskCount(0), nextIndex(0),
+    busyWorkers(0), generation(0), stopping(false) {
+    for (int w = 1; w < threads; w++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        unique_lock<mutex> guard(lock);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (thread &worker : workers) worker.join();
+}
+
+/* Calls task(i) for every i in [0, count), spreading the indexes
+   over all threads. Returns once every call has finished. */
+void ThreadPool::parallelFor(int count, const function<void(int)> &task) {
+    if (count <= 0) return;
+    if (workers.empty() || count == 1) { // nothing to distribute
+        for (int i = 0; i < count; i++) task(i);
+        return;
+    }
+    
+    {
+        unique_lock<mutex> guard(lock);
+        this->task = &task;
+        taskCount = count;
+        nextIndex = 0;
+        busyWorkers = workers.size();
+        generation++;
+    }
+    wakeUp.notify_all();
+    
+    runClaimedTasks(); // the calling thread works as well
+    
+    unique_lock<mutex> guard(lock);
+    loopFinished.wait(guard, [this]() { return busyWorkers == 0; });
+    this->task = nullptr;
+}
+
+void ThreadPool::workerLoop() {
+    unsigned int seenGeneration = 0;
+    unique_lock<mutex> guard(lock);
+    
+    while (true) {
+        wakeUp.wait(guard, [&]() { return stopping || generation != seenGeneration; });
+        if (stopping) return;
+        seenGeneration = generation;
+        
+        guard.unlock();
+        runClaimedTasks();
+        guard.lock();
+        
+        if (--busyWorkers == 0) loopFinished.notify_all();
+    }
+}
+
+/* Claims loop indexes one by one until all of them are taken. */
+void ThreadPool::runClaimedTasks() {
+    int index;
+    while ((index = nextIndex.fetch_add(1)) < taskCount) {
+        (*task)(index);
+    }
+}
+
+/* number of threads supported by the hardware (at least one) */
+int getHardwareThreads() {
+    return max(1u, thread::hardware_concurrency());
+}
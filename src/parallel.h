@@ -0,0 +1,54 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+using std::vector;
+using std::thread;
+using std::mutex;
+using std::atomic;
+using std::function;
+using std::condition_variable;
+
+
+/* Fixed-size pool of worker threads executing parallel loops.
+   The calling thread takes part in every loop, so a pool created
+   for "threads" threads spawns threads-1 workers. The pool is not
+   reentrant: parallelFor must not be called from within a task. */
+class ThreadPool {
+    private:
+        vector<thread> workers;
+        mutex lock;
+        condition_variable wakeUp;      // signals a new loop (or shutdown)
+        condition_variable loopFinished;
+        
+        const function<void(int)> *task; // body of the current loop
+        int taskCount;                   // loop indexes are [0, taskCount)
+        atomic<int> nextIndex;           // first index not yet claimed
+        int busyWorkers;                 // workers still running the current loop
+        unsigned int generation;         // incremented on every loop
+        bool stopping;
+    
+    public:
+        ThreadPool(int threads);
+        ~ThreadPool();
+        
+        int getThreadCount() { return workers.size() + 1; }
+        
+        /* Calls task(i) for every i in [0, count), spreading the indexes
+           over all threads. Returns once every call has finished. */
+        void parallelFor(int count, const function<void(int)> &task);
+    
+    private:
+        void workerLoop();
+        void runClaimedTasks();
+};
+
+/* number of threads supported by the hardware (at least one) */
+int getHardwareThreads();
+
+#endif
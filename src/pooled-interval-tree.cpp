@@ -0,0 +1,255 @@
+#include "pooled-interval-tree.h"
+#include <cassert>
+#include <limits>
+using std::max;
+using std::numeric_limits;
+
+
+static_assert(sizeof(PooledIntervalNode) == 24, "unexpected PooledIntervalNode layout");
+
+PooledIntervalTree::PooledIntervalTree() : root(0), highRoot(0), nodeCount(0) {
+    // The sentinel: height 0, count 0 and the lowest possible "highest" value.
+    pool.push_back({0, 0, numeric_limits<int>::min(), 0, 0, 0, 0});
+}
+
+/* Removes all intervals; the pool keeps its capacity. */
+void PooledIntervalTree::clear() {
+    pool.resize(1); // only the sentinel stays
+    freeNodes.clear();
+    root = 0;
+    highRoot = 0;
+    nodeCount = 0;
+}
+
+uint32_t PooledIntervalTree::allocateNode(int low, int high) {
+    if (!freeNodes.empty()) {
+        uint32_t node = freeNodes.back();
+        freeNodes.pop_back();
+        pool[node] = {low, high, high, 1, 0, 0, 1};
+        return node;
+    }
+    assert (pool.size() < (1u << 26));
+    pool.push_back({low, high, high, 1, 0, 0, 1});
+    return pool.size() - 1;
+}
+
+void PooledIntervalTree::releaseNode(uint32_t node) {
+    freeNodes.push_back(node);
+}
+
+/* Searches for the specified interval in the tree. */
+bool PooledIntervalTree::contains(int low, int high) const {
+    assert (low <= high);
+    pair<int,int> target(low, high);
+    uint32_t node = root;
+    while (node != 0) {
+        pair<int,int> range(pool[node].low, pool[node].high);
+        if (range == target) return true;
+        node = range > target ? pool[node].left : pool[node].right;
+    }
+    return false;
+}
+
+using IntervalList = vector<pair<int,int>>;
+
+/* Returns all intervals stored in the tree that overlap
+   with the query interval, ordered by their bounds. */
+IntervalList PooledIntervalTree::getClashes(int low, int high) const {
+    assert (low <= high);
+    IntervalList result;
+    forEachClash(low, high, [&result](int clashLow, int clashHigh) {
+        result.emplace_back(clashLow, clashHigh);
+    });
+    return result; // no copy here (move semantics)
+}
+
+/* Returns the number of intervals stored in the tree
+   that overlap with the query interval. */
+int PooledIntervalTree::countClashes(int low, int high) const {
+    assert (low <= high);
+    /* Intervals ending before "low" also start before "high", hence
+       the clashing ones are those starting no later than "high",
+       apart from the ones that end too early. */
+    return countStartingUpTo(root, high) - countStartingUpTo(highRoot, low - 1);
+}
+
+/* number of nodes with low <= bound in the tree rooted in treeRoot
+   (a single root-leaf walk) */
+int PooledIntervalTree::countStartingUpTo(uint32_t treeRoot, int bound) const {
+    int result = 0;
+    uint32_t node = treeRoot;
+    while (node != 0) {
+        if (pool[node].low <= bound) {
+            result += pool[pool[node].left].count + 1;
+            node = pool[node].right;
+        }
+        else node = pool[node].left;
+    }
+    return result;
+}
+
+/* Updates the auxiliary values in the node, assuming the children
+   have already been processed. */
+void PooledIntervalTree::updateAuxValues(uint32_t node) {
+    PooledIntervalNode &current = pool[node];
+    current.height = 1 + max(pool[current.left].height, pool[current.right].height);
+    current.count = 1 + pool[current.left].count + pool[current.right].count;
+    current.highest = max(current.high,
+                      max(pool[current.left].highest, pool[current.right].highest));
+}
+
+int PooledIntervalTree::getBalance(uint32_t node) const {
+    return (int)pool[pool[node].left].height - (int)pool[pool[node].right].height;
+}
+
+/* AVL right-rotation procedure, called when the node is unbalanced.
+   Preserves the correct order of the elements. */
+uint32_t PooledIntervalTree::rotateRight(uint32_t node) {
+    uint32_t subtreeRoot = pool[node].left;
+    pool[node].left = pool[subtreeRoot].right;
+    pool[subtreeRoot].right = node;
+    updateAuxValues(node);
+    updateAuxValues(subtreeRoot);
+    return subtreeRoot;
+}
+
+/* AVL left-rotation procedure, called when the node is unbalanced.
+   Preserves the correct order of the elements. */
+uint32_t PooledIntervalTree::rotateLeft(uint32_t node) {
+    uint32_t subtreeRoot = pool[node].right;
+    pool[node].right = pool[subtreeRoot].left;
+    pool[subtreeRoot].left = node;
+    updateAuxValues(node);
+    updateAuxValues(subtreeRoot);
+    return subtreeRoot;
+}
+
+/* Returns a balanced tree rooted in the provided node. */
+uint32_t PooledIntervalTree::balanceTree(uint32_t node) {
+    int rootBalance = getBalance(node);
+    assert (abs(rootBalance) <= 2);
+    
+    if (rootBalance == 2) { // Tree is leaning left.
+        if (getBalance(pool[node].left) < 0) {
+            pool[node].left = rotateLeft(pool[node].left); // double rotation
+        }
+        return rotateRight(node);
+    }
+    else if (rootBalance == -2) { // Tree is leaning right.
+        if (getBalance(pool[node].right) > 0) {
+            pool[node].right = rotateRight(pool[node].right); // double rotation
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+/* Walks back along the path, reattaching the (rebalanced) subtree
+   "child" to every node of the path; returns the new root. */
+uint32_t PooledIntervalTree::rebalancePath(uint32_t *path, bool *wentLeft,
+                                           int depth, uint32_t child) {
+    for (int i = depth - 1; i >= 0; i--) {
+        if (wentLeft[i]) pool[path[i]].left = child;
+        else pool[path[i]].right = child;
+        updateAuxValues(path[i]);
+        child = balanceTree(path[i]);
+    }
+    return child;
+}
+
+/* Inserts a new [low, high] interval. The tree can store
+   multiple intervals that have the same endpoints. */
+void PooledIntervalTree::insert(int low, int high) {
+    assert (low <= high);
+    insertInto(root, low, high);
+    insertInto(highRoot, high, high);
+    nodeCount++;
+}
+
+void PooledIntervalTree::insertInto(uint32_t &treeRoot, int low, int high) {
+    pair<int,int> addend(low, high);
+    uint32_t path[MAX_HEIGHT];
+    bool wentLeft[MAX_HEIGHT];
+    int depth = 0;
+    
+    for (uint32_t node = treeRoot; node != 0; depth++) {
+        path[depth] = node;
+        wentLeft[depth] = pair<int,int>(pool[node].low, pool[node].high) >= addend;
+        node = wentLeft[depth] ? pool[node].left : pool[node].right;
+    }
+    uint32_t added = allocateNode(low, high); // may move the pool, nothing is cached
+    treeRoot = rebalancePath(path, wentLeft, depth, added);
+}
+
+/* Removes one occurrence of the specified interval.
+   Has no effect if there is no such interval. */
+void PooledIntervalTree::remove(int low, int high) {
+    assert (low <= high);
+    if (!removeFrom(root, low, high)) return; // not present in the tree
+    removeFrom(highRoot, high, high);
+    nodeCount--;
+}
+
+bool PooledIntervalTree::removeFrom(uint32_t &treeRoot, int low, int high) {
+    pair<int,int> target(low, high);
+    uint32_t path[MAX_HEIGHT];
+    bool wentLeft[MAX_HEIGHT];
+    int depth = 0;
+    
+    // Walk down the tree, searching for the node to be removed.
+    uint32_t node = treeRoot;
+    while (node != 0) {
+        pair<int,int> range(pool[node].low, pool[node].high);
+        if (range == target) break;
+        path[depth] = node;
+        wentLeft[depth] = range > target;
+        node = wentLeft[depth] ? pool[node].left : pool[node].right;
+        depth++;
+    }
+    if (node == 0) return false;
+    
+    uint32_t replacement;
+    if (pool[node].left == 0 || pool[node].right == 0) {
+        /* Case #1. Target node has at most one child,
+                    replace it with the child subtree. */
+        replacement = pool[node].left == 0 ? pool[node].right : pool[node].left;
+        releaseNode(node);
+    }
+    else {
+        /* Case #2. Target node has both children - it takes over the interval
+           of its successor, which is removed from the right subtree instead. */
+        path[depth] = node;
+        wentLeft[depth++] = false;
+        uint32_t successor = pool[node].right;
+        while (pool[successor].left != 0) {
+            path[depth] = successor;
+            wentLeft[depth++] = true;
+            successor = pool[successor].left;
+        }
+        pool[node].low = pool[successor].low;
+        pool[node].high = pool[successor].high;
+        replacement = pool[successor].right;
+        releaseNode(successor);
+    }
+    treeRoot = rebalancePath(path, wentLeft, depth, replacement);
+    return true;
+}
+
+/* Prints the bracket representation of the tree (for debug purposes) */
+void PooledIntervalTree::printTree(ostream &outputStream) {
+    printTreeHelper(root, outputStream);
+    outputStream << "\n";
+}
+
+void PooledIntervalTree::printTreeHelper(uint32_t node, ostream &outputStream) {
+    if (node == 0) {
+        outputStream << "n"; // empty subtree symbol
+        return;
+    }
+    outputStream << "(";
+    printTreeHelper(pool[node].left, outputStream);
+    outputStream << ",[" << pool[node].low << "," << pool[node].high << "],"
+                 << "h=" << pool[node].height << ",hs=" << pool[node].highest << ",";
+    printTreeHelper(pool[node].right, outputStream);
+    outputStream << ")";
+}
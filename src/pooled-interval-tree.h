@@ -0,0 +1,133 @@
+#ifndef POOLED_INTERVAL_TREE_H
+#define POOLED_INTERVAL_TREE_H
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <cstdint>
+using std::ostream;
+using std::vector;
+using std::pair;
+
+
+/* Node of the PooledIntervalTree. Children are 32-bit indices into the
+   node pool (0 stands for no child); the AVL height lives in the spare
+   bits of the right child index, leaving 2^26 usable indices. */
+struct PooledIntervalNode {
+    int low, high;      // describes the [low, high] interval
+    int highest;        // maximum "high" value in the subtree
+    uint32_t count;     // total number of nodes in the subtree
+    uint32_t left;      // index of the left subtree
+    uint32_t right : 26; // index of the right subtree
+    uint32_t height : 6; // node count on the longest root-leaf path
+};
+
+/* Same interface and semantics as IntervalTree (an augmented AVL tree),
+   but all nodes live in one contiguous pool with a free list, so there
+   is no allocation per insertion once the pool has grown, and queries
+   as well as updates run iteratively over an explicit stack. As in
+   IntervalTree, the "high" values are kept in a second AVL tree (nodes
+   [high, high], in the same pool), so that countClashes takes two
+   O(log n) rank queries. */
+class PooledIntervalTree {
+    private:
+        vector<PooledIntervalNode> pool; // pool[0] is a sentinel (empty subtree)
+        vector<uint32_t> freeNodes;      // released pool entries
+        uint32_t root;
+        uint32_t highRoot;               // tree of the "high" values
+        unsigned int nodeCount;
+        
+        // longest root-leaf path that fits into the 6-bit height field
+        static const int MAX_HEIGHT = 63;
+    
+    public:
+        PooledIntervalTree();
+        
+        unsigned int getIntervalCount() {
+            return nodeCount;
+        }
+        
+        /* Preallocates the pool for the given number of intervals. */
+        void reserve(unsigned int intervals) { pool.reserve(2 * intervals + 1); }
+        
+        /* Removes all intervals; the pool keeps its capacity. */
+        void clear();
+        
+        /* Searches for the specified interval in the tree. */
+        bool contains(int low, int high) const;
+        
+        /* Returns all intervals stored in the tree that overlap
+           with the query interval, ordered by their bounds. */
+        using IntervalList = vector<pair<int,int>>;
+        IntervalList getClashes(int low, int high) const;
+        
+        /* Returns the number of intervals stored in the tree
+           that overlap with the query interval. */
+        int countClashes(int low, int high) const;
+        
+        /* Calls visit(low, high) for every interval stored in the tree that
+           overlaps with the query interval, in the order of getClashes.
+           Nothing is allocated; the tree must not be modified meanwhile. */
+        template <typename F>
+        void forEachClash(int low, int high, F &&visit) const;
+        
+        /* Inserts a new [low, high] interval. The tree can store
+           multiple intervals that have the same endpoints. */
+        void insert(int low, int high);
+        
+        /* Removes one occurrence of the specified interval.
+           Has no effect if there is no such interval. */
+        void remove(int low, int high);
+        
+        /* Prints the bracket representation of the tree (for debug purposes) */
+        void printTree(ostream &outputStream);
+    
+    private:
+        /* insert and remove, on the tree rooted in treeRoot;
+           removeFrom returns false if there is no such interval */
+        void insertInto(uint32_t &treeRoot, int low, int high);
+        bool removeFrom(uint32_t &treeRoot, int low, int high);
+        
+        /* number of nodes with low <= bound in the tree rooted in treeRoot */
+        int countStartingUpTo(uint32_t treeRoot, int bound) const;
+        
+        uint32_t allocateNode(int low, int high);
+        void releaseNode(uint32_t node);
+        
+        /* Walks back along the path, reattaching the (rebalanced) subtree
+           "child" to every node of the path; returns the new root. */
+        uint32_t rebalancePath(uint32_t *path, bool *wentLeft, int depth, uint32_t child);
+        
+        void updateAuxValues(uint32_t node);
+        uint32_t rotateRight(uint32_t node);
+        uint32_t rotateLeft(uint32_t node);
+        uint32_t balanceTree(uint32_t node);
+        int getBalance(uint32_t node) const;
+        
+        void printTreeHelper(uint32_t node, ostream &outputStream);
+};
+
+/* In-order traversal; it ends at the first interval starting after "high". */
+template <typename F>
+void PooledIntervalTree::forEachClash(int low, int high, F &&visit) const {
+    uint32_t stack[MAX_HEIGHT];
+    int stackSize = 0;
+    uint32_t node = root;
+    
+    while (true) {
+        // Skip subtrees in which no interval reaches "low".
+        while (node != 0 && pool[node].highest >= low) {
+            stack[stackSize++] = node;
+            node = pool[node].left;
+        }
+        if (stackSize == 0) break;
+        node = stack[--stackSize];
+        
+        const PooledIntervalNode &current = pool[node];
+        if (current.low > high) break; // so does everything that follows
+        if (current.high >= low) visit(current.low, current.high);
+        node = current.right;
+    }
+}
+
+#endif
@@ -0,0 +1,60 @@
+
+#include "random-engine.h"
+
+
+// state expanded with splitmix64
+void Xoshiro256::seed(uint64_t value) {
+    for (uint64_t &word : state) {
+        value += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = value;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        word = z ^ (z >> 31);
+    }
+}
+
+void Xoshiro256::seed(seed_seq &sequence) {
+    vector<uint32_t> words(8);
+    sequence.generate(words.begin(), words.end());
+    for (int w = 0; w < 4; w++) {
+        state[w] = (static_cast<uint64_t>(words[2*w]) << 32) | words[2*w+1];
+    }
+    if (!(state[0] | state[1] | state[2] | state[3])) seed(0); // all-zero state is invalid
+}
+
+/* Selects the backend; an engine not used since the last seed
+   starts from that seed. */
+void RandomEngine::setType(EngineType newType) {
+    type = newType;
+    if (unseeded[type]) seedSelected();
+}
+
+void RandomEngine::seed(uint64_t value) {
+    seededWithValue = true;
+    seedValue = value;
+    unseeded[MERSENNE_TWISTER] = unseeded[XOSHIRO256] = true;
+    seedSelected();
+}
+
+void RandomEngine::seed(seed_seq &sequence) {
+    seededWithValue = false;
+    seedEntropy.resize(sequence.size());
+    sequence.param(seedEntropy.begin());
+    unseeded[MERSENNE_TWISTER] = unseeded[XOSHIRO256] = true;
+    seedSelected();
+}
+
+/* Applies the remembered seed to the selected engine only. */
+void RandomEngine::seedSelected() {
+    if (seededWithValue) {
+        if (type == MERSENNE_TWISTER) mersenne.seed(seedValue);
+        else xoshiro.seed(seedValue);
+    }
+    else {
+        seed_seq sequence(seedEntropy.begin(), seedEntropy.end());
+        if (type == MERSENNE_TWISTER) mersenne.seed(sequence);
+        else xoshiro.seed(sequence);
+    }
+    if (type == XOSHIRO256) hasLowerHalf = false;
+    unseeded[type] = false;
+}
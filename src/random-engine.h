@@ -0,0 +1,92 @@
+#ifndef RANDOM_ENGINE_H
+#define RANDOM_ENGINE_H
+
+#include <random>
+#include <cstdint>
+#include <vector>
+using std::mt19937;
+using std::vector;
+using std::seed_seq;
+
+
+enum EngineType { MERSENNE_TWISTER, XOSHIRO256 };
+
+/* xoshiro256** generator by Blackman and Vigna: 256 bits of state,
+   a handful of shifts and rotations per 64-bit output. */
+class Xoshiro256 {
+    private:
+        uint64_t state[4];
+    
+    public:
+        Xoshiro256() { seed(0); }
+        
+        void seed(uint64_t value);  // state expanded with splitmix64
+        void seed(seed_seq &sequence);
+        
+        uint64_t operator()() {
+            const uint64_t result = rotl(state[1] * 5, 7) * 9;
+            const uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+            return result;
+        }
+    
+    private:
+        static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+/* Uniform random bit generator (usable with <random> distributions)
+   backed by one of the supported engines. Every 64-bit xoshiro256**
+   output yields two 32-bit results, upper half first. Only the selected
+   engine is seeded; the seed is remembered, so an engine selected later
+   starts from that seed, as if it had been seeded along. */
+class RandomEngine {
+    private:
+        EngineType type;
+        mt19937 mersenne;
+        Xoshiro256 xoshiro;
+        
+        uint32_t lowerHalf;   // second half of the last xoshiro output
+        bool hasLowerHalf;
+        
+        // the last seed, either a value or seed_seq entropy
+        bool seededWithValue;
+        uint64_t seedValue;
+        vector<uint32_t> seedEntropy;
+        bool unseeded[2];     // per EngineType: last seed not applied yet
+        
+        void seedSelected();
+    
+    public:
+        using result_type = uint32_t;
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT32_MAX; }
+        
+        RandomEngine(EngineType type = MERSENNE_TWISTER) : type(type),
+            hasLowerHalf(false), seededWithValue(true), seedValue(0),
+            unseeded{false, false} {}
+        
+        void setType(EngineType newType);
+        EngineType getType() { return type; }
+        
+        void seed(uint64_t value);
+        void seed(seed_seq &sequence);
+        
+        result_type operator()() {
+            if (type == MERSENNE_TWISTER) return mersenne();
+            if (hasLowerHalf) {
+                hasLowerHalf = false;
+                return lowerHalf;
+            }
+            const uint64_t output = xoshiro();
+            lowerHalf = output;
+            hasLowerHalf = true;
+            return output >> 32;
+        }
+};
+
+#endif
@@ -27,7 +27,21 @@ void SegmentTree<ElemT>::insert(int leftBound, int rightBound, ElemT value) {
     assert (leftBound <= rightBound);
     
     pair<int,int> insertSegment = {leftBound, rightBound};
-    insertHelper(root, insertSegment, value);
+    insertHelper(root, insertSegment, value, false);
+}
+
+/* Reverts insert(leftBound, rightBound, value). Every index of the
+   range has to hold at least value, e.g. because of a matching
+   earlier insert over it: with unsigned ElemT, a node covering
+   smaller values would wrap around instead of going negative. */
+template <typename ElemT>
+void SegmentTree<ElemT>::remove(int leftBound, int rightBound, ElemT value) {
+    assert (0 <= leftBound && leftBound < size);
+    assert (0 <= rightBound && rightBound < size);
+    assert (leftBound <= rightBound);
+    
+    pair<int,int> removeSegment = {leftBound, rightBound};
+    insertHelper(root, removeSegment, value, true);
 }
 
 template <typename ElemT>
@@ -40,6 +54,32 @@ ElemT SegmentTree<ElemT>::query(int leftBound, int rightBound) {
     return queryHelper(root, querySegment);
 }
 
+/* Sets all values to zero and the index range to [0, newSize).
+   Nodes allocated so far are kept (and zeroed) as long as the current
+   root range is large enough, but not excessively, so a reused tree
+   stops allocating. */
+template <typename ElemT>
+void SegmentTree<ElemT>::reset(int newSize) {
+    pair<int,int> rootRange = getRootRange(newSize);
+    size = newSize;
+    // A root range up to 4 times too large only costs two extra levels.
+    if (root != nullptr && rootRange.second <= root->range.second &&
+        root->range.second < 4 * (rootRange.second + 1)) {
+        resetHelper(root);
+        return;
+    }
+    delete root;
+    root = new SegmentTreeNode<ElemT>(ElemT {}, ElemT {}, rootRange);
+}
+
+template <typename ElemT>
+void SegmentTree<ElemT>::resetHelper(auto *node) {
+    node->value = ElemT {};
+    node->lazy = ElemT {};
+    if (node->left) resetHelper(node->left);
+    if (node->right) resetHelper(node->right);
+}
+
 /* Pretty-printer of the entire segment tree, using breadth-first search. */
 template <typename ElemT>
 void SegmentTree<ElemT>::printTree(ostream &outputStream) {
@@ -97,20 +137,29 @@ int SegmentTree<ElemT>::overlapSize(auto &segA, auto &segB) {
     return min(segA.second, segB.second) - max(segA.first, segB.first) + 1;
 }
 
+/* Applies the update of value to the query range, or reverts it if inverse is set.
+   Lazy values of the ancestors are propagated first, so the value of a fully
+   covered node is exact when the update is applied or reverted. */
 template <typename ElemT>
-void SegmentTree<ElemT>::insertHelper(auto *node, pair<int,int> &query, ElemT &value) {
+void SegmentTree<ElemT>::insertHelper(auto *node, pair<int,int> &query, ElemT &value,
+                                      bool inverse) {
     if (contains(query, node->range)) {
-        node->lazy = update(node->lazy, value);
         int overlap = overlapSize(query, node->range);
-        node->value = update(node->value, multiAccumulate(overlap, value));
+        if (inverse) {
+            node->lazy = revert(node->lazy, value);
+            node->value = revert(node->value, multiAccumulate(overlap, value));
+        } else {
+            node->lazy = update(node->lazy, value);
+            node->value = update(node->value, multiAccumulate(overlap, value));
+        }
     }
     
     else if (nonemptyOverlap(query, node->range)) {
         allocateChildren(node);
         propagateDown(node);
         // Continue further down the tree.
-        insertHelper(node->left, query, value);
-        insertHelper(node->right, query, value);
+        insertHelper(node->left, query, value, inverse);
+        insertHelper(node->right, query, value, inverse);
         node->value = accumulate(node->left->value, node->right->value);
     }
 }
@@ -36,11 +36,12 @@ struct SegmentTreeNode {
 template <typename ElemT>
 class SegmentTree {
     private:
-        const int size;                // specifies the index range
+        int size;                      // specifies the index range
         SegmentTreeNode<ElemT> *root;  // pointer to root
         const ElemT neutral;           // value of an empty segment
         
         virtual ElemT update(const ElemT&, const ElemT&) = 0;     // called on insert
+        virtual ElemT revert(const ElemT&, const ElemT&) = 0;     // inverse of update
         virtual ElemT accumulate(const ElemT&, const ElemT&) = 0; // called on query
         
         /* applies the accumulation function multiple times to neutral */
@@ -49,13 +50,33 @@ class SegmentTree {
     public:
         SegmentTree(int size, ElemT neutral);
         
+        // nodes are owned by a single tree
+        SegmentTree(const SegmentTree&) = delete;
+        SegmentTree(SegmentTree &&other) noexcept :
+            size(other.size), root(other.root), neutral(other.neutral) {
+            other.root = nullptr;
+        }
+        
         ~SegmentTree() {
             delete root; // triggers cascade deletion
         }
         
         void insert(int leftBound, int rightBound, ElemT value);
+        
+        /* Reverts insert(leftBound, rightBound, value). Every index of the
+           range has to hold at least value, e.g. because of a matching
+           earlier insert over it: with unsigned ElemT, a node covering
+           smaller values would wrap around instead of going negative. */
+        void remove(int leftBound, int rightBound, ElemT value);
+        
         ElemT query(int leftBound, int rightBound);
         
+        /* Sets all values to zero and the index range to [0, newSize).
+           Nodes allocated so far are kept (and zeroed) as long as the current
+           root range is large enough, but not excessively, so a reused tree
+           stops allocating. */
+        void reset(int newSize);
+        
         void printTree(ostream &outputStream);
     
     private:
@@ -66,10 +87,11 @@ class SegmentTree {
         bool nonemptyOverlap(auto &segA, auto &segB);
         int overlapSize(auto &segA, auto &segB);
         
-        void insertHelper(auto *node, pair<int,int> &query, ElemT &value);
+        void insertHelper(auto *node, pair<int,int> &query, ElemT &value, bool inverse);
         ElemT queryHelper(auto *node, pair<int,int> &query);
         void allocateChildren(auto *node);
         void propagateDown(auto *node);
+        void resetHelper(auto *node);
 };
 
 /* (+, +) segment tree */
@@ -78,6 +100,7 @@ class SegmentTreePlusPlus : public SegmentTree<ElemT> {
     
     private:
         ElemT update(const ElemT &x, const ElemT &y) { return x + y; }
+        ElemT revert(const ElemT &x, const ElemT &y) { return x - y; }
         ElemT accumulate(const ElemT &x, const ElemT &y) { return x + y; }
         ElemT multiAccumulate(const int times, const ElemT &value) { return times * value; }
     
@@ -92,6 +115,7 @@ class SegmentTreePlusMax : public SegmentTree<ElemT> {
     
     private:
         ElemT update(const ElemT &x, const ElemT &y) { return x + y; }
+        ElemT revert(const ElemT &x, const ElemT &y) { return x - y; }
         ElemT accumulate(const ElemT &x, const ElemT &y) { return max(x, y); }
         ElemT multiAccumulate(const int times, const ElemT &value) { return value; }
     
@@ -2,9 +2,19 @@
 #include <cassert>
 #include <set>
 #include <utility>
+#include <algorithm>
 using std::set;
 using std::pair;
 using std::max;
+using std::min;
+using std::sort;
+using std::lower_bound;
+using std::unique;
+using std::make_heap;
+using std::push_heap;
+using std::pop_heap;
+using std::chrono::steady_clock;
+using std::chrono::duration;
 
 
 /* Efficient implementation of the IntervalProblemInstance
@@ -13,108 +23,407 @@ using std::max;
    FIRST_NODE_SELECTED or SECOND_NODE_SELECTED.
    "maxOutdegree" denotes the largest outdegree that appeared. */
 void solveInstance(IntervalProblemInstance &ipi, int &maxOutdegree) {
+    SolverWorkspace workspace;
+    solveInstance(ipi, maxOutdegree, workspace);
+}
+
+/* Same as above, but all data structures are taken from (and left in)
+   the workspace. */
+void solveInstance(IntervalProblemInstance &ipi, int &maxOutdegree,
+                   SolverWorkspace &workspace) {
     
-    vector<IntervalTree> setIntervals = buildEmptyIntervalTrees(ipi);
-    vector<IntervalTree> notsetIntervals = buildFullIntervalTrees(ipi);
-    OutdegManager outdeg = buildOutdegManager(ipi);
-    IntervalDict dict = constructIntervalDict(ipi);
-    
-    // Initialize a priority queue of unprocessed intervals.
-    set<Interval*, decltype(ScoreComparator)> queue(ScoreComparator);
-    for (Interval &intv : ipi.intervals) {
-        queue.insert(&intv);
+    workspace.reset(ipi);
+    switch (workspace.counterWidth) {
+        case COUNTER_8:
+            solvePrepared<uint8_t>(ipi, maxOutdegree, workspace);
+            break;
+        case COUNTER_16:
+            solvePrepared<uint16_t>(ipi, maxOutdegree, workspace);
+            break;
+        case COUNTER_32:
+            solvePrepared<uint32_t>(ipi, maxOutdegree, workspace);
+            break;
     }
+}
+
+/* Main loop of solveInstance, counting outdegrees with CounterT;
+   the workspace has to be reset for the instance beforehand. */
+template <typename CounterT>
+void solvePrepared(IntervalProblemInstance &ipi, int &maxOutdegree,
+                   SolverWorkspace &workspace) {
+    
+    auto &queue = workspace.queue; // priority queue of unprocessed intervals
     
     while (!queue.empty()) {
         /* Select the interval with the highest score.
            Interval score is defined as the number of clashes
            with intervals that already have a node assigned. */
-        Interval *current = *queue.begin();
-        assert (current->status == NOT_SET);
+        pop_heap(queue.begin(), queue.end(), QueueEntryComparator);
+        QueueEntry top = queue.back();
+        queue.pop_back();
+        Interval *current = top.interval;
+        if (current->status != NOT_SET || top.score != current->score) continue; // outdated
         
-        notsetIntervals[current->nodes.first]
-            .remove(current->startTime, current->endTime);
-        notsetIntervals[current->nodes.second]
-            .remove(current->startTime, current->endTime);
+        /* Increment the score of unprocessed intervals that clash
+           with the current interval. */
+        const int currentMaxOutdegree = assignInterval<CounterT>(current, workspace,
+            [&](Interval *tag) {
+                tag->score++; // the old queue entry becomes outdated
+                queue.push_back({tag->score, tag});
+                push_heap(queue.begin(), queue.end(), QueueEntryComparator);
+            });
         
-        const int fstCollisions = setIntervals[current->nodes.first]
-            .countClashes(current->startTime, current->endTime);
-        const int sndCollisions = setIntervals[current->nodes.second]
-            .countClashes(current->startTime, current->endTime);
+        maxOutdegree = max(currentMaxOutdegree, maxOutdegree);
+    }
+}
+
+/* Assigns the interval to the endpoint with fewer clashes among the assigned
+   intervals and calls onClash(tag) for every unprocessed interval clashing
+   with it at that endpoint. Returns the largest outdegree of the endpoint
+   during the interval. Only the structures of the two endpoints are used. */
+template <typename CounterT, typename F>
+int assignInterval(Interval *current, SolverWorkspace &workspace, F onClash) {
+    auto &setIntervals = workspace.setIntervals;
+    auto &notsetIntervals = workspace.notsetIntervals;
+    auto &outdeg = workspace.getOutdegTrees<CounterT>();
+    
+    notsetIntervals[current->nodes.first]
+        .remove(current->startTime, current->endTime);
+    notsetIntervals[current->nodes.second]
+        .remove(current->startTime, current->endTime);
+    
+    const int fstCollisions = setIntervals[current->nodes.first]
+        .countClashes(current->startTime, current->endTime);
+    const int sndCollisions = setIntervals[current->nodes.second]
+        .countClashes(current->startTime, current->endTime);
+    
+    if (fstCollisions > sndCollisions) current->status = SECOND_NODE_SELECTED;
+    else current->status = FIRST_NODE_SELECTED;
+    
+    // Update outdeg manager (in compressed time).
+    const int assignedNode = current->getAssignedNode();
+    const int startIndex = workspace.getTimeIndex(assignedNode, current->startTime);
+    const int endIndex = workspace.getTimeIndex(assignedNode, current->endTime);
+    outdeg[assignedNode].insert(startIndex, endIndex, +1);
+    
+    setIntervals[assignedNode]
+        .insert(current->startTime, current->endTime);
+    
+    notsetIntervals[assignedNode].forEachClash(current->startTime, current->endTime,
+        [&](int clashLow, int clashHigh) {
+            onClash(findIntervalWithTimeBounds(clashLow, clashHigh, workspace.dict));
+        });
+    
+    return outdeg[assignedNode].query(startIndex, endIndex);
+}
+
+/* Speculative parallel variant of solveInstance. */
+void solveInstanceSpeculative(IntervalProblemInstance &ipi, int &maxOutdegree,
+                              SolverWorkspace &workspace, int batchSize) {
+    
+    workspace.reset(ipi);
+    switch (workspace.counterWidth) {
+        case COUNTER_8:
+            solveSpeculativePrepared<uint8_t>(ipi, maxOutdegree, workspace, batchSize);
+            break;
+        case COUNTER_16:
+            solveSpeculativePrepared<uint16_t>(ipi, maxOutdegree, workspace, batchSize);
+            break;
+        case COUNTER_32:
+            solveSpeculativePrepared<uint32_t>(ipi, maxOutdegree, workspace, batchSize);
+            break;
+    }
+}
+
+/* Main loop of solveInstanceSpeculative (see solvePrepared). */
+template <typename CounterT>
+void solveSpeculativePrepared(IntervalProblemInstance &ipi, int &maxOutdegree,
+                              SolverWorkspace &workspace, int batchSize) {
+    
+    auto &queue = workspace.queue;
+    auto &batch = workspace.batch;
+    auto &deferred = workspace.deferred;
+    auto &batchClashes = workspace.batchClashes;
+    auto &batchOutdegree = workspace.batchOutdegree;
+    auto &vertexLock = workspace.vertexLock; // batch that locked the vertex
+    vertexLock.assign(ipi.V, 0);
+    if ((int)batchClashes.size() < batchSize) batchClashes.resize(batchSize);
+    int batchNumber = 0;
+    
+    while (!queue.empty()) {
+        /* Take the top-scoring intervals, skipping those sharing an
+           endpoint with an interval already in the batch; these are put
+           back and wait for one of the next batches. */
+        batchNumber++;
+        batch.clear();
+        deferred.clear();
+        while (!queue.empty() && (int)batch.size() < batchSize &&
+               (int)deferred.size() < batchSize) {
+            pop_heap(queue.begin(), queue.end(), QueueEntryComparator);
+            QueueEntry top = queue.back();
+            queue.pop_back();
+            Interval *current = top.interval;
+            if (current->status != NOT_SET || top.score != current->score) continue; // outdated
+            
+            int &fstLock = vertexLock[current->nodes.first];
+            int &sndLock = vertexLock[current->nodes.second];
+            if (fstLock == batchNumber || sndLock == batchNumber) {
+                deferred.push_back(top);
+            }
+            else {
+                fstLock = sndLock = batchNumber;
+                batch.push_back(current);
+            }
+        }
         
-        if (fstCollisions > sndCollisions) current->status = SECOND_NODE_SELECTED;
-        else current->status = FIRST_NODE_SELECTED;
+        /* Intervals of a batch have pairwise disjoint endpoints, hence
+           also disjoint per-vertex structures, and are assigned concurrently.
+           The dictionary is only read. */
+        batchOutdegree.assign(batch.size(), 0);
+        workspace.pool->parallelFor(batch.size(), [&](int k) {
+            batchClashes[k].clear();
+            batchOutdegree[k] = assignInterval<CounterT>(batch[k], workspace,
+                [&](Interval *tag) { batchClashes[k].push_back(tag); });
+        });
         
-        // Update outdeg manager.
-        const int assignedNode = current->getAssignedNode();
-        outdeg[assignedNode].insert(current->startTime, current->endTime, +1);
-        const int currentMaxOutdegree = outdeg[assignedNode]
-            .query(current->startTime, current->endTime);
+        // Rescoring follows the batch order, so the result is deterministic.
+        for (int k = 0; k < (int)batch.size(); k++) {
+            maxOutdegree = max(batchOutdegree[k], maxOutdegree);
+            for (Interval *tag : batchClashes[k]) {
+                tag->score++; // the old queue entry becomes outdated
+                queue.push_back({tag->score, tag});
+                push_heap(queue.begin(), queue.end(), QueueEntryComparator);
+            }
+        }
+        for (QueueEntry &entry : deferred) {
+            if (entry.score != entry.interval->score) continue; // rescored meanwhile
+            queue.push_back(entry);
+            push_heap(queue.begin(), queue.end(), QueueEntryComparator);
+        }
+    }
+}
+
+/* Solves copies of the instance with solveInstance and with
+   solveInstanceSpeculative, and returns how much larger the
+   speculative maximum outdegree is. */
+int measureSpeculativeDeviation(const IntervalProblemInstance &ipi,
+                                SolverWorkspace &workspace, int batchSize) {
+    IntervalProblemInstance serialCopy = ipi;
+    IntervalProblemInstance speculativeCopy = ipi;
+    int serialMaxOutdegree = 0, speculativeMaxOutdegree = 0;
+    solveInstance(serialCopy, serialMaxOutdegree, workspace);
+    solveInstanceSpeculative(speculativeCopy, speculativeMaxOutdegree,
+                             workspace, batchSize);
+    return speculativeMaxOutdegree - serialMaxOutdegree;
+}
+
+/* Optional local search after solveInstance, lowering the maximum
+   outdegree by re-pointing intervals. */
+int improveSolution(IntervalProblemInstance &ipi, int &maxOutdegree,
+                    SolverWorkspace &workspace, LocalSearchBudget budget) {
+    switch (workspace.counterWidth) {
+        case COUNTER_8:
+            return improvePrepared<uint8_t>(ipi, maxOutdegree, workspace, budget);
+        case COUNTER_16:
+            return improvePrepared<uint16_t>(ipi, maxOutdegree, workspace, budget);
+        case COUNTER_32:
+            return improvePrepared<uint32_t>(ipi, maxOutdegree, workspace, budget);
+    }
+    return 0;
+}
+
+/* Local search of improveSolution (see solvePrepared). */
+template <typename CounterT>
+int improvePrepared(IntervalProblemInstance &ipi, int &maxOutdegree,
+                    SolverWorkspace &workspace, LocalSearchBudget budget) {
+    
+    auto &setIntervals = workspace.setIntervals;
+    auto &outdeg = workspace.getOutdegTrees<CounterT>();
+    auto &candidates = workspace.candidates;
+    const auto start = steady_clock::now();
+    
+    // largest outdegree of vertex v at any time
+    auto getPeak = [&](int v) {
+        return (int)outdeg[v].query(0, max<int>(workspace.timeCoords[v].size(), 1) - 1);
+    };
+    
+    set<pair<int,int>> peaks; // (largest outdegree, vertex)
+    for (int v = 0; v < ipi.V; v++) peaks.emplace(getPeak(v), v);
+    
+    long long moves = 0;
+    int performedMoves = 0;
+    while (!peaks.empty()) {
+        const int peak = peaks.rbegin()->first;
+        const int v = peaks.rbegin()->second;
         
-        maxOutdegree = max(currentMaxOutdegree, maxOutdegree);
+        /* Intervals assigned to v that are active when its outdegree
+           reaches the peak; one of them has to leave v. */
+        candidates.clear();
+        setIntervals[v].forEachClash(0, ipi.timeframe, [&](int low, int high) {
+            const int startIndex = workspace.getTimeIndex(v, low);
+            const int endIndex = workspace.getTimeIndex(v, high);
+            if (outdeg[v].query(startIndex, endIndex) == peak) {
+                candidates.push_back(findIntervalWithTimeBounds(low, high, workspace.dict));
+            }
+        });
         
-        setIntervals[assignedNode]
-            .insert(current->startTime, current->endTime);
-		
-        /* Increment the score of unprocessed intervals that clash
-           with the current interval. */
-        auto clashesList = notsetIntervals[assignedNode]
-            .getClashes(current->startTime, current->endTime);
-        for (pair<int,int> &clash : clashesList) {
-            Interval* tag = findIntervalWithTimeBounds(
-                clash.first, clash.second, dict);
-            queue.erase(tag); // old key is invalidated
-            tag->score++;
-            queue.insert(tag);
+        Interval *moved = nullptr;
+        for (Interval *candidate : candidates) {
+            if (moves >= budget.maxMoves ||
+                duration<double, std::milli>(steady_clock::now() - start).count()
+                    >= budget.maxMillis) {
+                break;
+            }
+            moves++;
+            
+            const int u = candidate->nodes.first == v ?
+                candidate->nodes.second : candidate->nodes.first;
+            const int startIndex = workspace.getTimeIndex(u, candidate->startTime);
+            const int endIndex = workspace.getTimeIndex(u, candidate->endTime);
+            if (outdeg[u].query(startIndex, endIndex) + 1 < peak) {
+                moved = candidate;
+                break;
+            }
         }
+        if (moved == nullptr) break; // out of budget, or v is stuck at the peak
+        
+        // Re-point the interval from v to u.
+        const int u = moved->getAssignedNode() == moved->nodes.first ?
+            moved->nodes.second : moved->nodes.first;
+        peaks.erase({peak, v});
+        peaks.erase({getPeak(u), u});
         
-        queue.erase(current);
+        // The interval was inserted into outdeg[v] when it got assigned to v.
+        outdeg[v].remove(workspace.getTimeIndex(v, moved->startTime),
+                         workspace.getTimeIndex(v, moved->endTime), 1);
+        outdeg[u].insert(workspace.getTimeIndex(u, moved->startTime),
+                         workspace.getTimeIndex(u, moved->endTime), +1);
+        setIntervals[v].remove(moved->startTime, moved->endTime);
+        setIntervals[u].insert(moved->startTime, moved->endTime);
+        moved->status = moved->status == FIRST_NODE_SELECTED ?
+            SECOND_NODE_SELECTED : FIRST_NODE_SELECTED;
+        performedMoves++;
+        
+        peaks.emplace(getPeak(v), v);
+        peaks.emplace(getPeak(u), u);
     }
+    
+    if (!peaks.empty()) maxOutdegree = peaks.rbegin()->first;
+    return performedMoves;
 }
 
-/* Collects all intervals into a vector of interval trees. Each vertex
-   has a separate tree with intervals for which it can be selected. */
-vector<IntervalTree> buildEmptyIntervalTrees(const IntervalProblemInstance &ipi) {
-    vector<IntervalTree> intTrees(ipi.V);
-    return intTrees;
+const int SolverWorkspace::VERTEX_BLOCK;
+
+/* Prepares the workspace for solving the given instance. */
+void SolverWorkspace::reset(IntervalProblemInstance &ipi) {
+    const int V = ipi.V;
+    if ((int)setIntervals.size() < V) setIntervals.resize(V);
+    if ((int)notsetIntervals.size() < V) notsetIntervals.resize(V);
+    if ((int)timeCoords.size() < V) timeCoords.resize(V);
+    
+    counterWidth = selectCounterWidth(getDegreeBound(ipi));
+    switch (counterWidth) {
+        case COUNTER_8: growOutdegTrees<uint8_t>(V); break;
+        case COUNTER_16: growOutdegTrees<uint16_t>(V); break;
+        case COUNTER_32: growOutdegTrees<uint32_t>(V); break;
+    }
+    
+    bucketIntervals(ipi);
+    
+    /* The structures of every vertex are built from its own bucket only,
+       so blocks of vertices are set up concurrently; the result does not
+       depend on the number of threads. */
+    const int blocks = (V + VERTEX_BLOCK - 1) / VERTEX_BLOCK;
+    pool->parallelFor(blocks, [&](int block) {
+        const int last = min(V, (block + 1) * VERTEX_BLOCK);
+        for (int v = block * VERTEX_BLOCK; v < last; v++) resetVertex(v);
+    });
+    
+    dict.clear();
+    queue.clear();
+    for (Interval &intv : ipi.intervals) {
+        dict.push_back(&intv);
+        queue.push_back({intv.score, &intv});
+    }
+    sort(dict.begin(), dict.end(), TimeBoundsComparator);
+    make_heap(queue.begin(), queue.end(), QueueEntryComparator);
 }
 
-vector<IntervalTree> buildFullIntervalTrees(const IntervalProblemInstance &ipi) {
-    vector<IntervalTree> intTrees(ipi.V);
+/* Counting sort of the interval bounds by vertex: the bucket of vertex v
+   is bucketBounds[bucketStart[v], bucketStart[v+1]), in interval order. */
+void SolverWorkspace::bucketIntervals(const IntervalProblemInstance &ipi) {
+    /* Sizes are counted two positions ahead, so that after the prefix sums
+       bucketStart[v+1] is the start of bucket v and can serve as its write
+       cursor; once the bounds are placed it is the start of bucket v+1. */
+    bucketStart.assign(ipi.V + 2, 0);
     for (const Interval &intv : ipi.intervals) {
-        intTrees[intv.nodes.first].insert(intv.startTime, intv.endTime);
-        intTrees[intv.nodes.second].insert(intv.startTime, intv.endTime);
+        bucketStart[intv.nodes.first + 2]++;
+        bucketStart[intv.nodes.second + 2]++;
     }
-    return intTrees;
+    for (int v = 2; v < ipi.V + 2; v++) bucketStart[v] += bucketStart[v-1];
+    
+    bucketBounds.resize(2 * ipi.intervals.size());
+    for (const Interval &intv : ipi.intervals) {
+        pair<int,int> bounds(intv.startTime, intv.endTime);
+        bucketBounds[bucketStart[intv.nodes.first + 1]++] = bounds;
+        bucketBounds[bucketStart[intv.nodes.second + 1]++] = bounds;
+    }
+    bucketStart.pop_back();
 }
 
-/* Let "outdeg" be an OutdegManager object. Then, outdeg[v][t]
-   denotes the current outdegree of vertex v at time t. */
-OutdegManager buildOutdegManager(const IntervalProblemInstance &ipi) {
-    OutdegManager manager;
-    manager.reserve(ipi.V); // separate segment tree for every vertex
-    for (int v = 0; v < ipi.V; v++) {
-        manager.emplace_back(ipi.timeframe); // span over timeframe
+/* Sets up the structures of vertex v from its bucket. */
+void SolverWorkspace::resetVertex(int v) {
+    const pair<int,int> *first = bucketBounds.data() + bucketStart[v];
+    const pair<int,int> *last = bucketBounds.data() + bucketStart[v+1];
+    
+    setIntervals[v].clear();
+    notsetIntervals[v].assign(first, last);
+    
+    vector<int> &coords = timeCoords[v];
+    coords.clear();
+    for (const pair<int,int> *bounds = first; bounds != last; bounds++) {
+        coords.push_back(bounds->first);
+        coords.push_back(bounds->second);
+    }
+    sort(coords.begin(), coords.end());
+    coords.erase(unique(coords.begin(), coords.end()), coords.end());
+    
+    const int span = max<int>(coords.size(), 1); // span over compressed times
+    switch (counterWidth) {
+        case COUNTER_8: outdeg8[v].reset(span); break;
+        case COUNTER_16: outdeg16[v].reset(span); break;
+        case COUNTER_32: outdeg32[v].reset(span); break;
     }
-    return manager;
 }
 
-/* The IntervalDict structure is introduced for efficient lookup. */
-IntervalDict constructIntervalDict(IntervalProblemInstance &ipi) {
-    IntervalDict dict(TimeBoundsComparator);
-    for (Interval &intv : ipi.intervals) {
-        dict.emplace(&intv);
-    }
-    return dict;
+/* Makes sure there are trees of the given width for V vertices. */
+template <typename CounterT>
+void SolverWorkspace::growOutdegTrees(int V) {
+    OutdegTrees<CounterT> &outdeg = getOutdegTrees<CounterT>();
+    outdeg.reserve(V);
+    while ((int)outdeg.size() < V) outdeg.emplace_back(1, 0);
+}
+
+/* Returns the position of "time" in timeCoords[v]. */
+int SolverWorkspace::getTimeIndex(int v, int time) const {
+    auto position = lower_bound(timeCoords[v].begin(), timeCoords[v].end(), time);
+    assert (position != timeCoords[v].end() && *position == time);
+    return position - timeCoords[v].begin();
+}
+
+/* Narrowest counter type able to count up to degreeBound. */
+CounterWidth selectCounterWidth(int degreeBound) {
+    if (degreeBound <= numeric_limits<uint8_t>::max()) return COUNTER_8;
+    if (degreeBound <= numeric_limits<uint16_t>::max()) return COUNTER_16;
+    return COUNTER_32;
 }
 
-/* Allows for interval lookup by time bounds. */
+/* Allows for interval lookup by time bounds, in a vector
+   of intervals sorted with TimeBoundsComparator. */
 Interval* findIntervalWithTimeBounds(int startTime, int endTime,
-                                     const IntervalDict &dict) {
-    /* We take advantage of the fact that IntervalDict uses
-       a TimeBoundsComparator for ordering - we simply need
-       to search for a mock interval with given time bounds. */
+                                     const vector<Interval*> &sortedIntervals) {
     Interval mock = {static_cast<unsigned int>(startTime),
                      static_cast<unsigned int>(endTime)};
-    return *dict.find(&mock);
+    return *lower_bound(sortedIntervals.begin(), sortedIntervals.end(), &mock,
+                        TimeBoundsComparator);
 }
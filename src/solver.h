@@ -2,14 +2,18 @@
 #define SOLVER_H
 
 #include "converter.h"
-#include "interval-tree.h"
+#include "static-interval-index.h"
+#include "pooled-interval-tree.h"
 #include "segment-tree.h"
 #include "segment-tree.cpp"
+#include "parallel.h"
 #include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <set>
+#include <memory>
+#include <chrono>
 using std::vector;
-using std::set;
+using std::unique_ptr;
 
 
 /* Efficient implementation of the IntervalProblemInstance
@@ -19,35 +23,185 @@ using std::set;
    "maxOutdegree" denotes the largest outdegree that appeared. */
 void solveInstance(IntervalProblemInstance &ipi, int &maxOutdegree);
 
-/* Collects all intervals into a vector of interval trees. Each vertex
-   has a separate tree with intervals for which it can be selected. */
-vector<IntervalTree> buildEmptyIntervalTrees(const IntervalProblemInstance &ipi);
-vector<IntervalTree> buildFullIntervalTrees(const IntervalProblemInstance &ipi);
+struct SolverWorkspace;
 
-/* Let "outdeg" be an OutdegManager object. Then, outdeg[v][t]
-   denotes the current outdegree of vertex v at time t. */
-using OutdegManager = vector<SegmentTreePlusMax<uint8_t>>;
-OutdegManager buildOutdegManager(const IntervalProblemInstance &ipi);
+/* Same as above, but all data structures are taken from (and left in)
+   the workspace, so that repeated calls allocate no memory once the
+   workspace has grown to the size of the instances. */
+void solveInstance(IntervalProblemInstance &ipi, int &maxOutdegree,
+                   SolverWorkspace &workspace);
+
+/* Speculative parallel variant of solveInstance, for throughput on huge
+   instances. Instead of a single interval, every step takes a batch of up
+   to batchSize top-scoring intervals with pairwise disjoint endpoints
+   (intervals sharing a vertex with the batch wait for a later one) and
+   assigns them concurrently on the threads of the workspace. Rescoring
+   happens after the batch, so later intervals of a batch are assigned
+   with outdated scores and the maximum outdegree may differ from the one
+   of solveInstance (see measureSpeculativeDeviation); with batchSize 1
+   both are identical. The result does not depend on the thread count. */
+void solveInstanceSpeculative(IntervalProblemInstance &ipi, int &maxOutdegree,
+                              SolverWorkspace &workspace, int batchSize);
+
+/* Solves copies of the instance with solveInstance and with
+   solveInstanceSpeculative, and returns how much larger the
+   speculative maximum outdegree is. */
+int measureSpeculativeDeviation(const IntervalProblemInstance &ipi,
+                                SolverWorkspace &workspace, int batchSize);
+
+/* Limits of improveSolution: the number of evaluated moves
+   and the running time in milliseconds. */
+struct LocalSearchBudget {
+    long long maxMoves;
+    double maxMillis;
+};
+
+/* Optional local search after solveInstance (or solveInstanceSpeculative),
+   which has to be the last solver run on the workspace. Repeatedly takes
+   a vertex v whose outdegree reaches the current maximum M and re-points
+   an interval assigned to v, and active when v has outdegree M, to its
+   other endpoint u, provided the outdegree of u stays below M during
+   the interval. Every move is evaluated on the outdegree trees in
+   O(log deg(u)). Stops when the budget runs out or no such move exists
+   for the vertex; the maximum outdegree never grows. maxOutdegree is
+   updated and the number of performed moves returned. */
+int improveSolution(IntervalProblemInstance &ipi, int &maxOutdegree,
+                    SolverWorkspace &workspace, LocalSearchBudget budget);
+
+/* Outdegree counters, one (+, max) segment tree per vertex. The counter
+   type has to hold the largest outdegree of the instance, so it is picked
+   per instance (see selectCounterWidth); the neutral value of the trees
+   is zero, which is fine as outdegrees are never negative. */
+template <typename CounterT>
+using OutdegTrees = vector<SegmentTreePlusMax<CounterT>>;
+
+enum CounterWidth { COUNTER_8, COUNTER_16, COUNTER_32 };
+
+/* Narrowest counter type able to count up to degreeBound. */
+CounterWidth selectCounterWidth(int degreeBound);
 
 /* Compares intervals with respect to their time bounds (startTime, endTime).
    Note that no two intervals can have the exact same timestamps. */
-auto TimeBoundsComparator = [](const Interval *intA, const Interval *intB) {
+const auto TimeBoundsComparator = [](const Interval *intA, const Interval *intB) {
     return (*intA) < (*intB);
 };
 
-/* Compares intervals according to their current score (highest score first).
-   Time bounds comparison serves as a tiebreaker. */
-auto ScoreComparator = [](const Interval *intA, const Interval *intB) {
-    return intA->score > intB->score ||
-          (intA->score == intB->score && (*intA) < (*intB));
+/* Allows for interval lookup by time bounds, in a vector
+   of intervals sorted with TimeBoundsComparator. */
+Interval* findIntervalWithTimeBounds(int startTime, int endTime,
+                                     const vector<Interval*> &sortedIntervals);
+
+/* Entry of the priority queue of unprocessed intervals. Scores only grow,
+   so instead of updating an entry, a new one is pushed; entries whose
+   score differs from the current score of their interval are outdated. */
+struct QueueEntry {
+    unsigned int score;
+    Interval *interval;
+};
+
+/* Heap order (highest score first, time bounds as a tiebreaker):
+   does entry a rank below entry b? */
+const auto QueueEntryComparator = [](const QueueEntry &a, const QueueEntry &b) {
+    return a.score < b.score ||
+          (a.score == b.score && (*b.interval) < (*a.interval));
 };
 
-/* The IntervalDict structure is introduced for efficient lookup. */
-using IntervalDict = set<Interval*, decltype(TimeBoundsComparator)>;
-IntervalDict constructIntervalDict(IntervalProblemInstance &ipi);
+/* Data structures of solveInstance, kept between calls. reset() prepares
+   them for another instance in time proportional to its size; vectors only
+   grow and trees keep their nodes (see PooledIntervalTree::clear and
+   SegmentTree::reset), hence similar-sized instances allocate nothing.
+   The per-vertex part of reset() runs on "threads" threads. */
+struct SolverWorkspace {
+    vector<PooledIntervalTree> setIntervals;     // assigned intervals, per vertex
+    vector<StaticIntervalIndex> notsetIntervals; // unassigned intervals, per vertex
+    CounterWidth counterWidth;                   // chosen by reset
+    OutdegTrees<uint8_t> outdeg8;                // indexed by compressed time,
+    OutdegTrees<uint16_t> outdeg16;              // only the trees matching
+    OutdegTrees<uint32_t> outdeg32;              // counterWidth are in use
+    vector<vector<int>> timeCoords;              // see getTimeIndex
+    vector<Interval*> dict;                      // sorted by time bounds
+    vector<QueueEntry> queue;                    // binary heap (QueueEntryComparator)
+    vector<int> bucketStart;                     // see bucketIntervals
+    vector<pair<int,int>> bucketBounds;          // intervals incident to every vertex
+    
+    // state of solveInstanceSpeculative
+    vector<Interval*> batch;                     // intervals assigned concurrently
+    vector<QueueEntry> deferred;                 // postponed to the next batches
+    vector<vector<Interval*>> batchClashes;      // to be rescored, per batch interval
+    vector<int> batchOutdegree;                  // see assignInterval
+    vector<int> vertexLock;                      // batch number that took the vertex
+    
+    vector<Interval*> candidates;                // moves considered by improveSolution
+    
+    unique_ptr<ThreadPool> pool;
+    
+    // vertices set up by a single parallel task
+    static const int VERTEX_BLOCK = 256;
+    
+    SolverWorkspace(int threads = 1) : pool(new ThreadPool(threads)) {}
+    
+    void reset(IntervalProblemInstance &ipi);
+    
+    /* Outdegrees of a vertex only change at the start and end times of its
+       intervals, so outdeg[v] spans just those times (timeCoords[v], sorted),
+       i.e. O(deg(v)) leaves. A maximum over [start, end] of an incident
+       interval is attained at one of them. Returns the position of "time"
+       in timeCoords[v]; the time has to be one of the coordinates. */
+    int getTimeIndex(int v, int time) const;
+    
+    /* outdegree trees with the given counter type */
+    template <typename CounterT>
+    OutdegTrees<CounterT>& getOutdegTrees();
+    
+    /* Counting sort of the interval bounds by vertex: the bucket of vertex v
+       is bucketBounds[bucketStart[v], bucketStart[v+1]), in interval order. */
+    void bucketIntervals(const IntervalProblemInstance &ipi);
+    
+    /* Sets up the structures of vertex v from its bucket (called by reset,
+       concurrently for distinct vertices). */
+    void resetVertex(int v);
+    
+    /* Makes sure there are trees of the given width for V vertices. */
+    template <typename CounterT>
+    void growOutdegTrees(int V);
+};
 
-/* Allows for interval lookup by time bounds. */
-Interval* findIntervalWithTimeBounds(int startTime, int endTime,
-                                     const IntervalDict &dict);
+template <>
+inline OutdegTrees<uint8_t>& SolverWorkspace::getOutdegTrees<uint8_t>() {
+    return outdeg8;
+}
+
+template <>
+inline OutdegTrees<uint16_t>& SolverWorkspace::getOutdegTrees<uint16_t>() {
+    return outdeg16;
+}
+
+template <>
+inline OutdegTrees<uint32_t>& SolverWorkspace::getOutdegTrees<uint32_t>() {
+    return outdeg32;
+}
+
+/* Main loop of solveInstance, counting outdegrees with CounterT;
+   the workspace has to be reset for the instance beforehand. */
+template <typename CounterT>
+void solvePrepared(IntervalProblemInstance &ipi, int &maxOutdegree,
+                   SolverWorkspace &workspace);
+
+/* Main loop of solveInstanceSpeculative (see solvePrepared). */
+template <typename CounterT>
+void solveSpeculativePrepared(IntervalProblemInstance &ipi, int &maxOutdegree,
+                              SolverWorkspace &workspace, int batchSize);
+
+/* Local search of improveSolution (see solvePrepared). */
+template <typename CounterT>
+int improvePrepared(IntervalProblemInstance &ipi, int &maxOutdegree,
+                    SolverWorkspace &workspace, LocalSearchBudget budget);
+
+/* Assigns the interval to the endpoint with fewer clashes among the assigned
+   intervals and calls onClash(tag) for every unprocessed interval clashing
+   with it at that endpoint. Returns the largest outdegree of the endpoint
+   during the interval. Only the structures of the two endpoints are used. */
+template <typename CounterT, typename F>
+int assignInterval(Interval *current, SolverWorkspace &workspace, F onClash);
 
 #endif
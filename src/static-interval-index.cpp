@@ -0,0 +1,98 @@
+#include "static-interval-index.h"
+#include <algorithm>
+#include <cassert>
+using std::max;
+using std::sort;
+using std::is_sorted;
+using std::lower_bound;
+using std::upper_bound;
+using std::make_pair;
+
+const int StaticIntervalIndex::NONE;
+
+/* Replaces the contents of the index with the provided intervals.
+   The storage of the previous contents is reused. */
+void StaticIntervalIndex::assign(const vector<pair<int,int>> &batch) {
+    assign(batch.data(), batch.data() + batch.size());
+}
+
+/* Same as above, for the intervals in [first, last). */
+void StaticIntervalIndex::assign(const pair<int,int> *first, const pair<int,int> *last) {
+    intervals.assign(first, last);
+    if (!is_sorted(intervals.begin(), intervals.end())) {
+        sort(intervals.begin(), intervals.end());
+    }
+    aliveCount = intervals.size();
+    
+    leafCount = 1;
+    while (leafCount < (int)intervals.size()) leafCount *= 2;
+    maxHigh.assign(2 * leafCount, NONE);
+    for (int i = 0; i < (int)intervals.size(); i++) {
+        assert (intervals[i].first <= intervals[i].second);
+        maxHigh[leafCount + i] = intervals[i].second;
+    }
+    for (int node = leafCount - 1; node >= 1; node--) {
+        maxHigh[node] = max(maxHigh[2*node], maxHigh[2*node + 1]);
+    }
+}
+
+/* position of a remaining occurrence of the interval, or -1 */
+int StaticIntervalIndex::findAlive(int low, int high) const {
+    pair<int,int> target(low, high);
+    auto iter = lower_bound(intervals.begin(), intervals.end(), target);
+    for (; iter != intervals.end() && *iter == target; iter++) {
+        int position = iter - intervals.begin();
+        if (maxHigh[leafCount + position] != NONE) return position;
+    }
+    return -1;
+}
+
+/* Searches for the specified interval in the index. */
+bool StaticIntervalIndex::contains(int low, int high) const {
+    assert (low <= high);
+    return findAlive(low, high) != -1;
+}
+
+/* number of intervals with low <= bound */
+int StaticIntervalIndex::getPrefixEnd(int bound) const {
+    auto iter = upper_bound(intervals.begin(), intervals.end(),
+                            make_pair(bound, numeric_limits<int>::max()));
+    return iter - intervals.begin();
+}
+
+using IntervalList = vector<pair<int,int>>;
+
+/* Returns all intervals stored in the index that overlap
+   with the query interval, ordered by their bounds. */
+IntervalList StaticIntervalIndex::getClashes(int low, int high) const {
+    assert (low <= high);
+    IntervalList result;
+    forEachClash(low, high, [&result](int clashLow, int clashHigh) {
+        result.emplace_back(clashLow, clashHigh);
+    });
+    return result; // no copy here (move semantics)
+}
+
+/* Returns the number of intervals stored in the index
+   that overlap with the query interval. */
+int StaticIntervalIndex::countClashes(int low, int high) const {
+    assert (low <= high);
+    int clashes = 0;
+    forEachClash(low, high, [&clashes](int, int) { clashes++; });
+    return clashes;
+}
+
+/* Removes one occurrence of the specified interval.
+   Has no effect if there is no such interval. */
+void StaticIntervalIndex::remove(int low, int high) {
+    assert (low <= high);
+    int position = findAlive(low, high);
+    if (position == -1) return;
+    
+    aliveCount--;
+    int node = leafCount + position;
+    maxHigh[node] = NONE; // tombstone
+    for (node /= 2; node >= 1; node /= 2) {
+        maxHigh[node] = max(maxHigh[2*node], maxHigh[2*node + 1]);
+    }
+}
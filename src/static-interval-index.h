@@ -0,0 +1,102 @@
+#ifndef STATIC_INTERVAL_INDEX_H
+#define STATIC_INTERVAL_INDEX_H
+
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <limits>
+using std::ostream;
+using std::vector;
+using std::pair;
+using std::numeric_limits;
+
+
+/* Interval index built once from a batch of intervals, which afterwards
+   can only be removed. Intervals are kept in an array sorted by their
+   (low, high) bounds; a bottom-up max tree over that array stores the
+   largest "high" among the remaining intervals of every range. Removed
+   intervals are tombstoned, i.e. they stay in the array, but their leaves
+   no longer contribute to the max tree. Construction takes O(n log n)
+   (O(n) for a sorted batch), removal O(log n), and a clash query visits
+   O((k+1) log n) entries for k reported intervals. There is no per-interval
+   allocation; compare with IntervalTree, which also supports insertions. */
+class StaticIntervalIndex {
+    private:
+        vector<pair<int,int>> intervals; // sorted by (low, high)
+        vector<int> maxHigh;             // implicit tree, leaves at [leafCount, 2*leafCount)
+        int leafCount;                   // power of two, at least intervals.size()
+        unsigned int aliveCount;
+        
+        // marks an empty range or a tombstone
+        static const int NONE = numeric_limits<int>::min();
+    
+    public:
+        StaticIntervalIndex() : leafCount(1), aliveCount(0) {}
+        StaticIntervalIndex(const vector<pair<int,int>> &batch) { assign(batch); }
+        
+        /* Replaces the contents of the index with the provided intervals.
+           The storage of the previous contents is reused. */
+        void assign(const vector<pair<int,int>> &batch);
+        
+        /* Same as above, for the intervals in [first, last). */
+        void assign(const pair<int,int> *first, const pair<int,int> *last);
+        
+        unsigned int getIntervalCount() {
+            return aliveCount;
+        }
+        
+        /* Searches for the specified interval in the index. */
+        bool contains(int low, int high) const;
+        
+        /* Returns all intervals stored in the index that overlap
+           with the query interval, ordered by their bounds. */
+        using IntervalList = vector<pair<int,int>>;
+        IntervalList getClashes(int low, int high) const;
+        
+        /* Returns the number of intervals stored in the index
+           that overlap with the query interval. */
+        int countClashes(int low, int high) const;
+        
+        /* Calls visit(low, high) for every interval stored in the index that
+           overlaps with the query interval, in the order of getClashes.
+           Nothing is allocated; the index must not be modified meanwhile. */
+        template <typename F>
+        void forEachClash(int low, int high, F &&visit) const {
+            visitClashes(1, 0, leafCount, getPrefixEnd(high), low, visit);
+        }
+        
+        /* Removes one occurrence of the specified interval.
+           Has no effect if there is no such interval. */
+        void remove(int low, int high);
+    
+    private:
+        /* position of a remaining occurrence of the interval, or -1 */
+        int findAlive(int low, int high) const;
+        
+        /* number of intervals with low <= bound, i.e. the only ones that may
+           clash with a query ending at bound */
+        int getPrefixEnd(int bound) const;
+        
+        /* Visits the remaining intervals of positions [nodeFrom, nodeTo) that lie
+           in the prefix [0, prefixEnd) and end no earlier than "low". */
+        template <typename F>
+        void visitClashes(int node, int nodeFrom, int nodeTo, int prefixEnd,
+                          int low, F &visit) const;
+};
+
+template <typename F>
+void StaticIntervalIndex::visitClashes(int node, int nodeFrom, int nodeTo, int prefixEnd,
+                                       int low, F &visit) const {
+    // Skip the range if it starts too late or no interval in it ends late enough.
+    if (nodeFrom >= prefixEnd || maxHigh[node] < low) return;
+    
+    if (node >= leafCount) {
+        visit(intervals[nodeFrom].first, intervals[nodeFrom].second);
+        return;
+    }
+    int nodeMiddle = (nodeFrom + nodeTo) / 2;
+    visitClashes(2*node, nodeFrom, nodeMiddle, prefixEnd, low, visit);
+    visitClashes(2*node + 1, nodeMiddle, nodeTo, prefixEnd, low, visit);
+}
+
+#endif